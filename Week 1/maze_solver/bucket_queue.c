@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bucket_queue.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* One growable array of elements with the same key. */
+struct bucket {
+    int *data;
+    size_t size;
+    size_t capacity;
+};
+
+/* The bucket for key k is buckets[k & mask]. 'min_key' is never above the
+ * lowest key in the queue, so pop only scans forward from it. */
+struct bucket_queue {
+    struct bucket *buckets;
+    size_t mask;
+    int min_key;
+    size_t size;
+
+    int num_of_pushes;
+    int num_of_pops;
+    size_t max_elements;
+};
+
+struct bucket_queue *bucket_queue_init(size_t n_buckets) {
+    struct bucket_queue *bq = malloc(sizeof(struct bucket_queue));
+    if (bq == NULL) {
+        debug_print("Could not allocate memory for bucket queue struct\n");
+        return NULL;
+    }
+
+    // A power of two number of buckets, so the circular index is a mask.
+    size_t count = 1;
+    while (count < n_buckets) {
+        count <<= 1;
+    }
+
+    bq->buckets = calloc(count, sizeof(struct bucket));
+    if (bq->buckets == NULL) {
+        debug_print("Could not allocate memory for buckets\n");
+        free(bq);
+        return NULL;
+    }
+
+    bq->mask = count - 1;
+    bq->min_key = 0;
+    bq->size = 0;
+
+    bq->num_of_pushes = 0;
+    bq->num_of_pops = 0;
+    bq->max_elements = 0;
+
+    return bq;
+}
+
+void bucket_queue_cleanup(struct bucket_queue *bq) {
+    if (bq == NULL) {
+        debug_print("Invalid bucket queue struct in bucket_queue_cleanup\n");
+        return;
+    }
+
+    for (size_t b = 0; b <= bq->mask; b++) {
+        free(bq->buckets[b].data);
+    }
+    free(bq->buckets);
+    free(bq);
+}
+
+void bucket_queue_stats(const struct bucket_queue *bq) {
+    if (bq == NULL) {
+        debug_print("Invalid bucket queue struct in bucket_queue_stats\n");
+        return;
+    }
+
+    fprintf(stderr, "stats %d %d %zu\n",
+                    bq->num_of_pushes,
+                    bq->num_of_pops,
+                    bq->max_elements);
+}
+
+int bucket_queue_push(struct bucket_queue *bq, int key, int e) {
+    if (bq == NULL) {
+        debug_print("Invalid bucket queue struct in bucket_queue_push\n");
+        return 1;
+    }
+
+    if (e < 0) {
+        debug_print("No negative numbers are allowed in the bucket queue\n");
+        return 1;
+    }
+
+    // An empty queue can move to any key range, but only when it has to:
+    // the caller may still push keys down to the last popped key.
+    if (bq->size == 0 && (key < bq->min_key
+                          || (size_t) (key - bq->min_key) > bq->mask)) {
+        bq->min_key = key;
+    }
+
+    if (key < bq->min_key || (size_t) (key - bq->min_key) > bq->mask) {
+        debug_print("Key out of the range of the bucket queue\n");
+        return 1;
+    }
+
+    struct bucket *b = &bq->buckets[(size_t) key & bq->mask];
+    if (b->size == b->capacity) {
+        size_t capacity = b->capacity ? 2 * b->capacity : 16;
+        int *data = realloc(b->data, capacity * sizeof(int));
+        if (data == NULL) {
+            debug_print("Could not grow bucket\n");
+            return 1;
+        }
+        b->data = data;
+        b->capacity = capacity;
+    }
+
+    b->data[b->size] = e;
+    b->size++;
+    bq->size++;
+    bq->num_of_pushes++;
+
+    if (bq->size > bq->max_elements) {
+        bq->max_elements = bq->size;
+    }
+
+    return 0;
+}
+
+int bucket_queue_pop(struct bucket_queue *bq, int *key) {
+    if (bq == NULL) {
+        debug_print("Invalid bucket queue struct in bucket_queue_pop\n");
+        return -1;
+    }
+
+    if (bq->size == 0) {
+        debug_print("Bucket queue is empty, can't pop element\n");
+        return -1;
+    }
+
+    struct bucket *b = &bq->buckets[(size_t) bq->min_key & bq->mask];
+    while (b->size == 0) {
+        bq->min_key++;
+        b = &bq->buckets[(size_t) bq->min_key & bq->mask];
+    }
+
+    if (key != NULL) {
+        *key = bq->min_key;
+    }
+    b->size--;
+    bq->size--;
+    bq->num_of_pops++;
+    return b->data[b->size];
+}
+
+int bucket_queue_empty(const struct bucket_queue *bq) {
+    if (bq == NULL) {
+        debug_print("Invalid bucket queue struct in bucket_queue_empty\n");
+        return -1;
+    }
+
+    return bq->size == 0 ? 1 : 0;
+}
+
+size_t bucket_queue_size(const struct bucket_queue *bq) {
+    return bq->size;
+}
@@ -0,0 +1,37 @@
+#include <stddef.h>
+
+/* Handle to bucket queue.
+ *
+ * A bucket queue is a priority queue for small integer keys. It keeps one
+ * bucket per key in a circular array, so push and pop are O(1) as long as
+ * the keys are monotone: a pushed key may not be lower than the lowest key
+ * in the queue and must be less than 'n_buckets' above it. */
+struct bucket_queue;
+
+/* Return a pointer to a bucket queue that can hold keys spread over at least
+ * 'n_buckets' consecutive values if successful, otherwise return NULL. */
+struct bucket_queue *bucket_queue_init(size_t n_buckets);
+
+/* Cleanup bucket queue. */
+void bucket_queue_cleanup(struct bucket_queue *bq);
+
+/* Print bucket queue statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements */
+void bucket_queue_stats(const struct bucket_queue *bq);
+
+/* Push item 'e' with priority 'key'.
+ * Return 0 if successful, 1 otherwise. */
+int bucket_queue_push(struct bucket_queue *bq, int key, int e);
+
+/* Remove an item with the lowest key and return it. If 'key' is not NULL the
+ * key of the item is stored in it. Items with equal keys are returned last
+ * in, first out.
+ * Return the item if successful, -1 otherwise. */
+int bucket_queue_pop(struct bucket_queue *bq, int *key);
+
+/* Return 1 if the bucket queue is empty, 0 if it contains any elements and
+ * return -1 if the operation fails. */
+int bucket_queue_empty(const struct bucket_queue *bq);
+
+/* Return the number of elements stored in the bucket queue. */
+size_t bucket_queue_size(const struct bucket_queue *bq);
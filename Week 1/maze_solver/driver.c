@@ -0,0 +1,347 @@
+// Needed for clock_gettime()
+#define _POSIX_C_SOURCE 200809L
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "driver.h"
+#include "maze.h"
+#include "path.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* The options of every solver, see driver.h. */
+#define COMMON_OPTIONS "pTZsr:"
+
+/* Room for the common options and those of the solver. */
+#define MAX_OPTIONS 64
+
+/* The options of one run of the driver and where its results go: the paths
+ * of -o to 'out' through 'path', the lines of the results to 'report'. */
+struct settings {
+    int flags;
+    bool print_stats;
+    int thumbnail_size;
+    const char *query_file;
+    const char *path_file;
+    const char *maze_file;
+
+    struct path *path;
+    FILE *out;
+    FILE *report;
+};
+
+/* Prints the usage of 'd', with -o if the solver can store its path in
+ * 'paths', even if an option took it away since. */
+static void print_usage(const struct driver *d, const char *program,
+                        bool paths) {
+    fprintf(stderr, "usage: %s [-p|-T|-Z] [-s] [-r size] %s%s%s"
+            "[maze_file] < maze\n", program, d->usage ? d->usage : "",
+            d->queries ? "[-q queries] " : "",
+            paths ? "[-o path_file] " : "");
+}
+
+/* Parses the options of 'argv' into 's', passing those of the solver on to
+ * 'd->option'.
+ * Returns 0 if successful, 1 if the command line is not valid. */
+static int parse_options(struct driver *d, int argc, char *argv[],
+                         struct settings *s) {
+    static const struct option no_long_options[] = {
+        {NULL, 0, NULL, 0},
+    };
+    char options[MAX_OPTIONS];
+    snprintf(options, sizeof(options), "%s%s%s%s", COMMON_OPTIONS,
+             d->queries ? "q:" : "", d->solve_path ? "o:" : "",
+             d->options ? d->options : "");
+    const struct option *long_options = d->long_options ? d->long_options
+                                                        : no_long_options;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, options, long_options,
+                              NULL)) != -1) {
+        switch (opt) {
+        case 'p':
+            s->flags |= MAZE_PACKED;
+            break;
+        case 'T':
+            s->flags |= MAZE_TILED;
+            break;
+        case 'Z':
+            s->flags |= MAZE_MORTON;
+            break;
+        case 's':
+            s->print_stats = true;
+            break;
+        case 'r':
+            s->thumbnail_size = atoi(optarg);
+            break;
+        case 'q':
+            s->query_file = optarg;
+            s->flags |= MAZE_EPOCH;
+            break;
+        case 'o':
+            s->path_file = optarg;
+            break;
+        case '?':
+            return 1;
+        default:
+            if (!d->option || d->option(d, opt, optarg)) {
+                return 1;
+            }
+        }
+    }
+
+    // An option of the solver may have taken away its path, e.g. -b
+    if (s->path_file && !d->solve_path) {
+        return 1;
+    }
+    if (optind + 1 < argc) {
+        return 1;
+    }
+    s->maze_file = optind < argc ? argv[optind] : NULL;
+    return 0;
+}
+
+/* Runs the search of 'd' on 'm', into 'path' if there is one. In a maze
+ * with labeled components a destination in another component than the
+ * start is NOT_FOUND without searching. */
+static int search(const struct driver *d, struct maze *m, bool print_stats,
+                  struct path *path) {
+    int r_start, c_start, r_destination, c_destination;
+    maze_start(m, &r_start, &c_start);
+    maze_destination(m, &r_destination, &c_destination);
+    if (!maze_reachable(m, r_start, c_start, r_destination, c_destination)) {
+        return NOT_FOUND;
+    }
+
+    if (path) {
+        return d->solve_path(m, print_stats, path);
+    }
+    return d->solve(m, print_stats);
+}
+
+/* Writes the path of a search that returned 'path_length' to 's->out' if
+ * there is one, or the record of no path, so every search of -o has one.
+ * Returns 0 if successful, 1 otherwise. */
+static int write_path(const struct settings *s, int path_length) {
+    if (path_length == NOT_FOUND) {
+        return path_write_none(s->out);
+    }
+    return path_write(s->path, s->out);
+}
+
+/* Answers the queries in 'fp' with 'd', one per line as the row and column
+ * of the start followed by the row and column of the destination. The maze
+ * is reset between queries instead of reloaded. Prints one path length per
+ * query to 's->report', or NOT_FOUND if there is no path or a location is
+ * not a FLOOR. With -o the path of every query is also written to 's->out',
+ * see write_path().
+ * Returns 0 if successful, 1 if a query could not be read or solved. */
+static int solve_queries(const struct driver *d, struct maze *m, FILE *fp,
+                         const struct settings *s) {
+    int r_start, c_start, r_destination, c_destination;
+    int n_read;
+
+    while ((n_read = fscanf(fp, "%d %d %d %d", &r_start, &c_start,
+                            &r_destination, &c_destination)) == 4) {
+        if (!maze_valid_move(m, r_start, c_start)
+            || !maze_valid_move(m, r_destination, c_destination)
+            || maze_get(m, r_start, c_start) == WALL
+            || maze_get(m, r_destination, c_destination) == WALL) {
+            if (s->path && write_path(s, NOT_FOUND)) {
+                return 1;
+            }
+            fprintf(s->report, "%d\n", NOT_FOUND);
+            continue;
+        }
+
+        maze_set_start(m, r_start, c_start);
+        maze_set_destination(m, r_destination, c_destination);
+        int path_length = search(d, m, s->print_stats, s->path);
+        if (path_length == ERROR || (s->path && write_path(s, path_length))) {
+            return 1;
+        }
+        fprintf(s->report, "%d\n", path_length);
+        maze_reset(m);
+    }
+
+    if (n_read != EOF) {
+        fprintf(stderr, "Malformed query, expected 4 integers\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* Runs the batch of 'd' on 'm': the queries of 's->query_file', or else its
+ * 'run'. The 'time' line of -s covers the whole batch.
+ * Returns 0 if successful, 1 otherwise. */
+static int run_batch(const struct driver *d, struct maze *m,
+                     const struct settings *s) {
+    struct timespec t_start;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+    int status;
+    if (s->query_file) {
+        FILE *fp = fopen(s->query_file, "r");
+        if (!fp) {
+            fprintf(stderr, "Cannot open file %s\n", s->query_file);
+            return 1;
+        }
+        // Labeling once lets unreachable queries skip their search. Without
+        // labels, e.g. for a maze too large to label, every query searches.
+        maze_label_components(m);
+        status = solve_queries(d, m, fp, s);
+        fclose(fp);
+    } else {
+        status = d->run(m, s->print_stats);
+    }
+
+    if (s->print_stats) {
+        driver_print_time("time", &t_start);
+    }
+    if (status) {
+        fprintf(s->report, "%s failed\n", d->name);
+    }
+    return status;
+}
+
+/* Runs the setup of 'd' on 'm' and with -s prints its seconds as the
+ * 'setup' line.
+ * Returns 0 if successful, 1 otherwise. */
+static int run_setup(const struct driver *d, struct maze *m,
+                     const struct settings *s) {
+    struct timespec t_start;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    int status = d->setup(m, s->maze_file, s->print_stats);
+    if (s->print_stats && status == 0) {
+        driver_print_time("setup", &t_start);
+    }
+    return status;
+}
+
+/* Solves 'm' once with 'd' and prints the result: the maze with its path,
+ * or with -o the path written to 's->out'.
+ * Returns 0 if a path is found, 1 otherwise. */
+static int solve_once(const struct driver *d, struct maze *m,
+                      const struct settings *s) {
+    struct timespec t_start;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    int path_length = search(d, m, s->print_stats, s->path);
+    if (s->print_stats) {
+        driver_print_time("time", &t_start);
+    }
+
+    if (s->path && path_length != ERROR && write_path(s, path_length)) {
+        return 1;
+    }
+    if (driver_report(d, path_length, s->report)) {
+        return 1;
+    }
+    if (s->path) {
+        return 0;
+    }
+
+    /* print maze */
+    maze_print(m, false);
+    maze_output_thumbnail(m, "out.ppm", s->thumbnail_size);
+    return 0;
+}
+
+int driver_main(struct driver *d, int argc, char *argv[]) {
+    struct settings s = {.flags = MAZE_BYTES};
+    bool paths = d->solve_path != NULL;
+    if (parse_options(d, argc, argv, &s)) {
+        print_usage(d, argv[0], paths);
+        return 1;
+    }
+
+    // With the paths on stdout the result lines go to stderr
+    bool paths_on_stdout = s.path_file && strcmp(s.path_file, "-") == 0;
+    s.report = paths_on_stdout ? stderr : stdout;
+
+    /* read maze, from the given file or else from stdin */
+    struct maze *m;
+    if (s.maze_file) {
+        m = maze_read_file(s.maze_file, s.flags);
+    } else {
+        m = maze_read_flags(s.flags);
+    }
+    if (!m) {
+        fprintf(s.report, "Error reading maze\n");
+        return 1;
+    }
+
+    /* the path goes to its own file instead of into the maze */
+    if (s.path_file) {
+        s.path = path_init();
+        s.out = paths_on_stdout ? stdout : fopen(s.path_file, "w");
+        if (!s.path || !s.out) {
+            fprintf(stderr, "Cannot open file %s\n", s.path_file);
+            if (s.path) {
+                path_cleanup(s.path);
+            }
+            maze_cleanup(m);
+            return 1;
+        }
+    }
+
+    int status;
+    if (!d->large_mazes && maze_cells(m) > INT_MAX) {
+        fprintf(stderr, "Maze too large for %s, use maze_solver\n", d->name);
+        fprintf(s.report, "%s failed\n", d->name);
+        status = 1;
+    } else if (d->setup && run_setup(d, m, &s)) {
+        fprintf(s.report, "%s failed\n", d->name);
+        status = 1;
+    } else {
+        if (s.query_file || d->run) {
+            status = run_batch(d, m, &s);
+        } else {
+            status = solve_once(d, m, &s);
+        }
+        if (d->cleanup) {
+            d->cleanup();
+        }
+    }
+
+    if (s.path) {
+        path_cleanup(s.path);
+    }
+    if (s.out && s.out != stdout && fclose(s.out)) {
+        status = 1;
+    }
+    maze_cleanup(m);
+    return status;
+}
+
+int driver_report(const struct driver *d, int path_length, FILE *fp) {
+    if (path_length == ERROR) {
+        fprintf(fp, "%s failed\n", d->name);
+        return 1;
+    }
+    if (path_length == NOT_FOUND) {
+        fprintf(fp, "no path found from start to destination\n");
+        return 1;
+    }
+
+    fprintf(fp, "%s found a path of length: %d", d->name, path_length);
+    if (d->print_found) {
+        d->print_found(fp);
+    }
+    fprintf(fp, "\n");
+    return 0;
+}
+
+void driver_print_time(const char *label, const struct timespec *t_start) {
+    struct timespec t_end;
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    fprintf(stderr, "%s %.6f\n", label,
+            (double) (t_end.tv_sec - t_start->tv_sec)
+            + (double) (t_end.tv_nsec - t_start->tv_nsec) / 1e9);
+}
@@ -0,0 +1,101 @@
+#include <stdbool.h>
+#include <stdio.h>
+
+/* The main program of the solvers.
+ *
+ * A solver fills in a struct driver with its name and its search and calls
+ * driver_main() from main(). The driver parses the options every solver
+ * has, reads the maze, times the search and prints the result:
+ *
+ *   -p, -T, -Z    store the maze bit-packed, in tiles or in Z-ordered tiles
+ *   -s            print the 'stats' line of the search and a 'time' line
+ *                 with its seconds to stderr, and before them a 'setup'
+ *                 line with the seconds of 'setup' if the solver has one
+ *   -r size       write out.ppm as a thumbnail of at most 'size' pixels
+ *   -q queries    answer the queries in the given file instead of solving
+ *                 once, if the solver sets 'queries'
+ *   -o path_file  write the path as runs of moves to the given file, or to
+ *                 stdout for -, instead of printing the maze, if the solver
+ *                 has 'solve_path'. Every search writes a record, see
+ *                 path_write_none(), and for - the result lines go to
+ *                 stderr so stdout only holds paths
+ *
+ * and then the maze file, or the maze is read from stdin. */
+
+/* Forward declarations for using struct maze, struct path, struct option
+ * and struct timespec pointers in the prototypes. */
+struct maze;
+struct path;
+struct option;
+struct timespec;
+
+/* A solver as the driver runs it. Only 'name' and 'solve' are required, the
+ * other members may be zero. */
+struct driver {
+    /* Name of the solver in its result lines, e.g. 'bfs' in 'bfs found a
+     * path of length: 12'. */
+    const char *name;
+
+    /* Solves 'm' from its start to its destination, marks the cells it
+     * expands VISITED and the path PATH, and with 'print_stats' prints its
+     * 'stats' line to stderr.
+     * Returns the length of the path, -1 if there is no path and -2 if an
+     * error occured. */
+    int (*solve)(struct maze *m, bool print_stats);
+
+    /* Same as 'solve', but stores the path in 'path' instead of marking it,
+     * see path.h. */
+    int (*solve_path)(struct maze *m, bool print_stats, struct path *path);
+
+    /* The options of the solver itself: their getopt letters, e.g. "t:",
+     * their usage, e.g. "[-t threads] ", and their long options. 'option'
+     * is called with every one of them and its argument, or NULL, and may
+     * change 'd'.
+     * Returns 0 if successful, 1 if the option is not valid. */
+    const char *options;
+    const char *usage;
+    const struct option *long_options;
+    int (*option)(struct driver *d, int opt, const char *arg);
+
+    /* Prepares the searches on maze 'm', read from 'maze_file' or from
+     * stdin if it is NULL, e.g. builds an index. It is timed apart from the
+     * searches, in the 'setup' line of -s.
+     * Returns 0 if successful, 1 otherwise. */
+    int (*setup)(struct maze *m, const char *maze_file, bool print_stats);
+
+    /* Frees what 'setup' made. */
+    void (*cleanup)(void);
+
+    /* Prints what follows the length in the line of a path found, e.g.
+     * " and cost: 20". */
+    void (*print_found)(FILE *fp);
+
+    /* Runs instead of the single search if it is set, usually by an option
+     * for a batch mode. Its seconds are the 'time' line of -s.
+     * Returns 0 if successful, 1 otherwise. */
+    int (*run)(struct maze *m, bool print_stats);
+
+    /* True if the search works for any start and destination, so -q can set
+     * them for every query. */
+    bool queries;
+
+    /* True if the search also handles mazes of more than INT_MAX cells,
+     * see maze_index64(). Other searches index cells with ints, so the
+     * driver does not run them on such a maze. */
+    bool large_mazes;
+};
+
+/* Run solver 'd' with the command line 'argv'.
+ * Return the exit status of the program: 0 if a path is found or every
+ * query is answered, 1 otherwise. */
+int driver_main(struct driver *d, int argc, char *argv[]);
+
+/* Print the line of a search by 'd' that returned 'path_length' to 'fp':
+ * the length of the path found, that there is none, or that it failed.
+ * Return 0 if a path is found, 1 otherwise. */
+int driver_report(const struct driver *d, int path_length, FILE *fp);
+
+/* Print 'label' and the seconds since 't_start', which is read with
+ * clock_gettime(CLOCK_MONOTONIC), as a line to stderr, e.g. the 'time' line
+ * of -s. */
+void driver_print_time(const char *label, const struct timespec *t_start);
@@ -0,0 +1,33 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The frontier of a search: a growable ring buffer of cell indices that is
+ * used as a queue (push at the back, pop at the front) by breadth first
+ * search and as a stack (push and pop at the back) by depth first search.
+ *
+ * Unlike the queue and stack modules everything here is static inline and
+ * does not check its arguments, so a push or pop in the hot loop of a search
+ * compiles to a few instructions on the array. The caller makes sure it only
+ * pops from a frontier that is not empty. The capacity is always a power of
+ * two, so wrapping around is a mask.
+ *
+ * 'struct frontier' holds int indices, 'struct frontier64' int64_t indices
+ * for mazes with more cells than fit in an int. The functions are named
+ * after the struct: frontier_push(), frontier64_push() and so on. */
+#define FRONTIER_CAT2(a, b) a##_##b
+#define FRONTIER_CAT(a, b) FRONTIER_CAT2(a, b)
+#define FRONTIER_FN(name) FRONTIER_CAT(FRONTIER, name)
+
+#define FRONTIER frontier
+#define FRONTIER_ELEMENT int
+#include "frontier_core.h"
+#undef FRONTIER
+#undef FRONTIER_ELEMENT
+
+#define FRONTIER frontier64
+#define FRONTIER_ELEMENT int64_t
+#include "frontier_core.h"
+#undef FRONTIER
+#undef FRONTIER_ELEMENT
@@ -0,0 +1,108 @@
+/* The frontier type and its functions, generated once for every element
+ * type. frontier.h includes this file after defining:
+ *
+ *   FRONTIER          the name of the struct and the prefix of the functions
+ *   FRONTIER_ELEMENT  the type of the elements
+ */
+struct FRONTIER {
+    FRONTIER_ELEMENT *data;
+    size_t head;
+    size_t size;
+    size_t capacity;
+
+    long num_of_pushes;
+    long num_of_pops;
+    size_t max_elements;
+};
+
+/* Initializes 'f' with room for 'capacity' elements, rounded up to a power
+ * of two. Returns 0 if successful, 1 otherwise. */
+static inline int FRONTIER_FN(init)(struct FRONTIER *f, size_t capacity) {
+    size_t p = 1;
+    while (p < capacity) {
+        p <<= 1;
+    }
+
+    f->data = malloc(sizeof(FRONTIER_ELEMENT) * p);
+    f->head = 0;
+    f->size = 0;
+    f->capacity = p;
+    f->num_of_pushes = 0;
+    f->num_of_pops = 0;
+    f->max_elements = 0;
+    return f->data == NULL;
+}
+
+/* Frees the buffer of 'f'. */
+static inline void FRONTIER_FN(cleanup)(struct FRONTIER *f) {
+    free(f->data);
+    f->data = NULL;
+}
+
+/* Prints the statistics of 'f' to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements */
+static inline void FRONTIER_FN(stats)(const struct FRONTIER *f) {
+    fprintf(stderr, "stats %ld %ld %ld\n", f->num_of_pushes, f->num_of_pops,
+            (long) f->max_elements);
+}
+
+/* Doubles the capacity of the full frontier 'f'. The part of the elements
+ * that wrapped around to the start of the buffer is moved behind the old
+ * end, so they are contiguous again. Kept out of line, it runs only
+ * log(n) times.
+ * Returns 0 if successful, 1 otherwise. */
+static int FRONTIER_FN(grow)(struct FRONTIER *f) {
+    size_t bytes = sizeof(FRONTIER_ELEMENT) * 2 * f->capacity;
+    FRONTIER_ELEMENT *data = realloc(f->data, bytes);
+    if (data == NULL) {
+        return 1;
+    }
+    memcpy(data + f->capacity, data, sizeof(FRONTIER_ELEMENT) * f->head);
+
+    f->data = data;
+    f->capacity *= 2;
+    return 0;
+}
+
+/* Returns 1 if 'f' has no elements, 0 otherwise. */
+static inline int FRONTIER_FN(empty)(const struct FRONTIER *f) {
+    return f->size == 0;
+}
+
+/* Returns the number of elements in 'f'. */
+static inline size_t FRONTIER_FN(size)(const struct FRONTIER *f) {
+    return f->size;
+}
+
+/* Adds 'e' at the back of 'f'.
+ * Returns 0 if successful, 1 if the frontier could not grow. */
+static inline int FRONTIER_FN(push)(struct FRONTIER *f,
+                                    FRONTIER_ELEMENT e) {
+    if (f->size == f->capacity && FRONTIER_FN(grow)(f)) {
+        return 1;
+    }
+
+    f->data[(f->head + f->size) & (f->capacity - 1)] = e;
+    f->size++;
+    f->num_of_pushes++;
+    if (f->size > f->max_elements) {
+        f->max_elements = f->size;
+    }
+    return 0;
+}
+
+/* Removes the element at the front of 'f' and returns it (queue order). */
+static inline FRONTIER_ELEMENT FRONTIER_FN(pop_front)(struct FRONTIER *f) {
+    FRONTIER_ELEMENT e = f->data[f->head];
+    f->head = (f->head + 1) & (f->capacity - 1);
+    f->size--;
+    f->num_of_pops++;
+    return e;
+}
+
+/* Removes the element at the back of 'f' and returns it (stack order). */
+static inline FRONTIER_ELEMENT FRONTIER_FN(pop_back)(struct FRONTIER *f) {
+    f->size--;
+    f->num_of_pops++;
+    return f->data[(f->head + f->size) & (f->capacity - 1)];
+}
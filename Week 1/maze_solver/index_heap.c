@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "index_heap.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Slot 'i' of the heap holds element elements[i] with key keys[i], the
+ * children of slot i are slots 2i + 1 and 2i + 2. 'position' maps an element
+ * to its slot, or -1 if it is not in the heap. The slot arrays grow on
+ * demand, the position array covers every element. */
+struct index_heap {
+    int *elements;
+    uint64_t *keys;
+    int *position;
+    size_t n_elements;
+    size_t size;
+    size_t capacity;
+
+    int num_of_pushes;
+    int num_of_pops;
+    size_t max_elements;
+};
+
+struct index_heap *index_heap_init(size_t n_elements) {
+    struct index_heap *h = malloc(sizeof(struct index_heap));
+    if (h == NULL) {
+        debug_print("Could not allocate memory for indexed heap struct\n");
+        return NULL;
+    }
+
+    h->capacity = 64;
+    h->elements = malloc(h->capacity * sizeof(int));
+    h->keys = malloc(h->capacity * sizeof(uint64_t));
+    h->position = malloc(n_elements * sizeof(int));
+    if (h->elements == NULL || h->keys == NULL || h->position == NULL) {
+        debug_print("Could not allocate memory for indexed heap arrays\n");
+        free(h->elements);
+        free(h->keys);
+        free(h->position);
+        free(h);
+        return NULL;
+    }
+    for (size_t e = 0; e < n_elements; e++) {
+        h->position[e] = -1;
+    }
+    h->n_elements = n_elements;
+    h->size = 0;
+
+    h->num_of_pushes = 0;
+    h->num_of_pops = 0;
+    h->max_elements = 0;
+
+    return h;
+}
+
+void index_heap_cleanup(struct index_heap *h) {
+    if (h == NULL) {
+        debug_print("Invalid indexed heap struct in index_heap_cleanup\n");
+        return;
+    }
+
+    free(h->elements);
+    free(h->keys);
+    free(h->position);
+    free(h);
+}
+
+void index_heap_stats(const struct index_heap *h) {
+    if (h == NULL) {
+        debug_print("Invalid indexed heap struct in index_heap_stats\n");
+        return;
+    }
+
+    fprintf(stderr, "stats %d %d %zu\n",
+                    h->num_of_pushes,
+                    h->num_of_pops,
+                    h->max_elements);
+}
+
+/* Stores element 'e' with 'key' in slot 'i'. */
+static void place(struct index_heap *h, size_t i, int e, uint64_t key) {
+    h->elements[i] = e;
+    h->keys[i] = key;
+    h->position[e] = (int) i;
+}
+
+/* Moves the element in slot 'i' up until its parent has a lower key. */
+static void sift_up(struct index_heap *h, size_t i) {
+    int e = h->elements[i];
+    uint64_t key = h->keys[i];
+    while (i > 0 && h->keys[(i - 1) / 2] > key) {
+        size_t parent = (i - 1) / 2;
+        place(h, i, h->elements[parent], h->keys[parent]);
+        i = parent;
+    }
+    place(h, i, e, key);
+}
+
+/* Moves the element in slot 'i' down until its children have higher keys. */
+static void sift_down(struct index_heap *h, size_t i) {
+    int e = h->elements[i];
+    uint64_t key = h->keys[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= h->size) {
+            break;
+        }
+        if (child + 1 < h->size && h->keys[child + 1] < h->keys[child]) {
+            child++;
+        }
+        if (h->keys[child] >= key) {
+            break;
+        }
+        place(h, i, h->elements[child], h->keys[child]);
+        i = child;
+    }
+    place(h, i, e, key);
+}
+
+int index_heap_push(struct index_heap *h, int e, uint64_t key) {
+    if (h == NULL) {
+        debug_print("Invalid indexed heap struct in index_heap_push\n");
+        return 1;
+    }
+
+    if (e < 0 || (size_t) e >= h->n_elements) {
+        debug_print("Element out of the range of the indexed heap\n");
+        return 1;
+    }
+
+    if (h->position[e] != -1) {
+        // Change the key and restore the heap order in either direction
+        size_t i = (size_t) h->position[e];
+        uint64_t old_key = h->keys[i];
+        h->keys[i] = key;
+        if (key < old_key) {
+            sift_up(h, i);
+        } else {
+            sift_down(h, i);
+        }
+        return 0;
+    }
+
+    if (h->size == h->capacity) {
+        size_t capacity = 2 * h->capacity;
+        int *elements = realloc(h->elements, capacity * sizeof(int));
+        if (elements == NULL) {
+            debug_print("Could not grow indexed heap\n");
+            return 1;
+        }
+        h->elements = elements;
+        uint64_t *keys = realloc(h->keys, capacity * sizeof(uint64_t));
+        if (keys == NULL) {
+            debug_print("Could not grow indexed heap\n");
+            return 1;
+        }
+        h->keys = keys;
+        h->capacity = capacity;
+    }
+
+    place(h, h->size, e, key);
+    h->size++;
+    sift_up(h, h->size - 1);
+    h->num_of_pushes++;
+
+    if (h->size > h->max_elements) {
+        h->max_elements = h->size;
+    }
+
+    return 0;
+}
+
+void index_heap_remove(struct index_heap *h, int e) {
+    if (h->position[e] == -1) {
+        return;
+    }
+
+    size_t i = (size_t) h->position[e];
+    h->position[e] = -1;
+    h->size--;
+    if (i == h->size) {
+        return;
+    }
+
+    // Fill the hole with the last element and move it to its place
+    place(h, i, h->elements[h->size], h->keys[h->size]);
+    if (i > 0 && h->keys[(i - 1) / 2] > h->keys[i]) {
+        sift_up(h, i);
+    } else {
+        sift_down(h, i);
+    }
+}
+
+int index_heap_pop(struct index_heap *h) {
+    if (h == NULL) {
+        debug_print("Invalid indexed heap struct in index_heap_pop\n");
+        return -1;
+    }
+
+    if (h->size == 0) {
+        debug_print("Indexed heap is empty, can't pop element\n");
+        return -1;
+    }
+
+    int e = h->elements[0];
+    index_heap_remove(h, e);
+    h->num_of_pops++;
+    return e;
+}
+
+uint64_t index_heap_top_key(const struct index_heap *h) {
+    return h->size == 0 ? UINT64_MAX : h->keys[0];
+}
+
+int index_heap_contains(const struct index_heap *h, int e) {
+    return h->position[e] != -1;
+}
+
+size_t index_heap_size(const struct index_heap *h) {
+    return h->size;
+}
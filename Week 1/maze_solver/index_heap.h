@@ -0,0 +1,40 @@
+#include <stddef.h>
+#include <stdint.h>
+
+/* Handle to an indexed heap.
+ *
+ * An indexed heap is a binary min-heap of the elements 0 up to 'n_elements'
+ * that knows where every element is, so the key of an element in the heap
+ * can be changed and an element can be removed from the middle. */
+struct index_heap;
+
+/* Return a pointer to an indexed heap for the elements 0 up to
+ * 'n_elements' if successful, otherwise return NULL. */
+struct index_heap *index_heap_init(size_t n_elements);
+
+/* Cleanup indexed heap. */
+void index_heap_cleanup(struct index_heap *h);
+
+/* Print indexed heap statistics to stderr.
+ * The format is: 'stats' num_of_pushes num_of_pops max_elements */
+void index_heap_stats(const struct index_heap *h);
+
+/* Insert element 'e' with 'key', or change its key if it is in the heap.
+ * Return 0 if successful, 1 otherwise. */
+int index_heap_push(struct index_heap *h, int e, uint64_t key);
+
+/* Remove element 'e' from the heap if it is in it. */
+void index_heap_remove(struct index_heap *h, int e);
+
+/* Remove an element with the lowest key and return it.
+ * Return the element if successful, -1 otherwise. */
+int index_heap_pop(struct index_heap *h);
+
+/* Return the lowest key in the heap, or UINT64_MAX if it is empty. */
+uint64_t index_heap_top_key(const struct index_heap *h);
+
+/* Return 1 if element 'e' is in the heap, 0 otherwise. */
+int index_heap_contains(const struct index_heap *h, int e);
+
+/* Return the number of elements stored in the heap. */
+size_t index_heap_size(const struct index_heap *h);
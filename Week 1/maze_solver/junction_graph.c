@@ -0,0 +1,243 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "junction_graph.h"
+#include "maze.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* 'node_of' maps a maze index to its node or -1, 'cells' maps a node back to
+ * its maze index. The edges of node v are first[v] up to first[v + 1], for
+ * every edge the target node, the length and the move that leaves v are
+ * stored. The move is enough to walk the corridor again. */
+struct junction_graph {
+    int *node_of;
+    int *cells;
+    size_t *first;
+    int n_nodes;
+
+    int *targets;
+    int *weights;
+    unsigned char *moves;
+    size_t n_edges;
+    int max_weight;
+};
+
+/* Returns true if (r, c) can be entered. */
+static bool is_open(const struct maze *m, int r, int c) {
+    return maze_valid_move(m, r, c) && maze_get(m, r, c) != WALL;
+}
+
+/* Returns the number of open neighbours of (r, c). */
+static int open_neighbours(const struct maze *m, int r, int c) {
+    int count = 0;
+    for (int move = 0; move < N_MOVES; move++) {
+        count += is_open(m, r + m_offsets[move][0], c + m_offsets[move][1]);
+    }
+    return count;
+}
+
+/* Follows the corridor that leaves the node at 'index' with 'move' up to the
+ * next node, which is returned. The number of moves is stored in 'length'.
+ * If 'mark' is not NULL the corridor cells are marked PATH in it. */
+static int walk(const struct junction_graph *g, const struct maze *m,
+                int index, int move, int *length, struct maze *mark) {
+    int r = maze_row(m, index) + m_offsets[move][0];
+    int c = maze_col(m, index) + m_offsets[move][1];
+    *length = 1;
+
+    while (g->node_of[maze_index(m, r, c)] == -1) {
+        if (mark) {
+            maze_set(mark, r, c, PATH);
+        }
+        // A corridor cell has one exit besides the way back
+        int back = (move + 2) % N_MOVES;
+        for (move = 0; move < N_MOVES; move++) {
+            if (move != back
+                && is_open(m, r + m_offsets[move][0],
+                           c + m_offsets[move][1])) {
+                break;
+            }
+        }
+        r += m_offsets[move][0];
+        c += m_offsets[move][1];
+        (*length)++;
+    }
+
+    return g->node_of[maze_index(m, r, c)];
+}
+
+/* Finds the nodes of maze 'm' and counts their edges in 'first', which is
+ * turned into the start offsets later.
+ * Returns 0 if successful, 1 otherwise. */
+static int find_nodes(struct junction_graph *g, const struct maze *m) {
+    int rows = maze_rows(m);
+    int cols = maze_cols(m);
+    int r_start, c_start, r_dest, c_dest;
+    maze_start(m, &r_start, &c_start);
+    maze_destination(m, &r_dest, &c_dest);
+
+    for (int pass = 0; pass < 2; pass++) {
+        g->n_nodes = 0;
+        for (int r = 1; r < rows - 1; r++) {
+            for (int c = 1; c < cols - 1; c++) {
+                if (maze_get(m, r, c) == WALL) {
+                    continue;
+                }
+                int degree = open_neighbours(m, r, c);
+                if (degree == 2 && !(r == r_start && c == c_start)
+                    && !(r == r_dest && c == c_dest)) {
+                    continue;
+                }
+                if (pass == 1) {
+                    g->node_of[maze_index(m, r, c)] = g->n_nodes;
+                    g->cells[g->n_nodes] = maze_index(m, r, c);
+                    g->first[g->n_nodes + 1] = (size_t) degree;
+                }
+                g->n_nodes++;
+            }
+        }
+
+        // Size the node arrays after counting
+        if (pass == 0) {
+            g->cells = malloc((size_t) g->n_nodes * sizeof(int));
+            g->first = calloc((size_t) g->n_nodes + 1, sizeof(size_t));
+            if (g->cells == NULL || g->first == NULL) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Walks every corridor from both ends and stores it as an edge of the node
+ * it leaves.
+ * Returns 0 if successful, 1 otherwise. */
+static int find_edges(struct junction_graph *g, const struct maze *m) {
+    for (int v = 0; v < g->n_nodes; v++) {
+        g->first[v + 1] += g->first[v];
+    }
+    g->n_edges = g->first[g->n_nodes];
+    g->targets = malloc(g->n_edges * sizeof(int));
+    g->weights = malloc(g->n_edges * sizeof(int));
+    g->moves = malloc(g->n_edges);
+    if (g->targets == NULL || g->weights == NULL || g->moves == NULL) {
+        return 1;
+    }
+
+    g->max_weight = 0;
+    for (int v = 0; v < g->n_nodes; v++) {
+        size_t e = g->first[v];
+        int r = maze_row(m, g->cells[v]);
+        int c = maze_col(m, g->cells[v]);
+        for (int move = 0; move < N_MOVES; move++) {
+            if (!is_open(m, r + m_offsets[move][0], c + m_offsets[move][1])) {
+                continue;
+            }
+            int length;
+            g->targets[e] = walk(g, m, g->cells[v], move, &length, NULL);
+            g->weights[e] = length;
+            g->moves[e] = (unsigned char) move;
+            if (length > g->max_weight) {
+                g->max_weight = length;
+            }
+            e++;
+        }
+    }
+
+    return 0;
+}
+
+struct junction_graph *junction_graph_init(const struct maze *m) {
+    struct junction_graph *g = calloc(1, sizeof(struct junction_graph));
+    if (g == NULL) {
+        debug_print("Could not allocate memory for junction graph struct\n");
+        return NULL;
+    }
+
+    // Nodes are stored as int cell indices
+    size_t n_cells = maze_cells(m);
+    if (n_cells > INT_MAX) {
+        debug_print("Maze too large for junction graph\n");
+        free(g);
+        return NULL;
+    }
+    g->node_of = malloc(n_cells * sizeof(int));
+    if (g->node_of == NULL) {
+        debug_print("Could not allocate memory for junction graph nodes\n");
+        free(g);
+        return NULL;
+    }
+    for (size_t i = 0; i < n_cells; i++) {
+        g->node_of[i] = -1;
+    }
+
+    if (find_nodes(g, m) || find_edges(g, m)) {
+        debug_print("Could not allocate memory for junction graph\n");
+        junction_graph_cleanup(g);
+        return NULL;
+    }
+
+    return g;
+}
+
+void junction_graph_cleanup(struct junction_graph *g) {
+    if (g == NULL) {
+        debug_print("Invalid junction graph struct in "
+                    "junction_graph_cleanup\n");
+        return;
+    }
+
+    free(g->node_of);
+    free(g->cells);
+    free(g->first);
+    free(g->targets);
+    free(g->weights);
+    free(g->moves);
+    free(g);
+}
+
+int junction_graph_nodes(const struct junction_graph *g) {
+    return g->n_nodes;
+}
+
+size_t junction_graph_edges(const struct junction_graph *g) {
+    return g->n_edges;
+}
+
+int junction_graph_max_weight(const struct junction_graph *g) {
+    return g->max_weight;
+}
+
+int junction_graph_node(const struct junction_graph *g, int index) {
+    return g->node_of[index];
+}
+
+int junction_graph_cell(const struct junction_graph *g, int v) {
+    return g->cells[v];
+}
+
+size_t junction_graph_first_edge(const struct junction_graph *g, int v) {
+    return g->first[v];
+}
+
+int junction_graph_target(const struct junction_graph *g, size_t e) {
+    return g->targets[e];
+}
+
+int junction_graph_weight(const struct junction_graph *g, size_t e) {
+    return g->weights[e];
+}
+
+void junction_graph_mark_edge(const struct junction_graph *g, struct maze *m,
+                              int v, size_t e) {
+    int length;
+    walk(g, m, g->cells[v], g->moves[e], &length, m);
+}
@@ -0,0 +1,53 @@
+#include <stddef.h>
+
+/* Handle to a junction graph.
+ *
+ * A junction graph is a maze with its corridors contracted. Its nodes are
+ * the FLOOR cells that do not have exactly two open neighbours (junctions,
+ * dead ends and isolated cells) plus the start and the destination. Every
+ * corridor between two nodes becomes an edge weighted with its length in
+ * moves. The edges of a node are consecutive (compressed sparse rows), edge
+ * 'e' of node 'v' is numbered junction_graph_first_edge(g, v) + i. */
+struct junction_graph;
+
+/* Forward declaration for using a struct maze pointer in the prototypes. */
+struct maze;
+
+/* Return a pointer to the junction graph of maze 'm' if successful,
+ * otherwise return NULL. Only the walls, start and destination of 'm' are
+ * used. Mazes with more than INT_MAX cells are not supported. */
+struct junction_graph *junction_graph_init(const struct maze *m);
+
+/* Cleanup junction graph. */
+void junction_graph_cleanup(struct junction_graph *g);
+
+/* Return the number of nodes. */
+int junction_graph_nodes(const struct junction_graph *g);
+
+/* Return the number of edges, every corridor is counted once from each
+ * end. */
+size_t junction_graph_edges(const struct junction_graph *g);
+
+/* Return the weight of the longest edge. */
+int junction_graph_max_weight(const struct junction_graph *g);
+
+/* Return the node at maze index 'index', or -1 if that cell is not a node. */
+int junction_graph_node(const struct junction_graph *g, int index);
+
+/* Return the maze index of node 'v'. */
+int junction_graph_cell(const struct junction_graph *g, int v);
+
+/* Return the first edge of node 'v'. The edges of 'v' end where the edges of
+ * node v + 1 start. */
+size_t junction_graph_first_edge(const struct junction_graph *g, int v);
+
+/* Return the node edge 'e' leads to. */
+int junction_graph_target(const struct junction_graph *g, size_t e);
+
+/* Return the length of edge 'e' in moves. */
+int junction_graph_weight(const struct junction_graph *g, size_t e);
+
+/* Mark the corridor cells of edge 'e' of node 'v' as PATH in maze 'm', not
+ * including the two nodes at its ends. */
+void junction_graph_mark_edge(const struct junction_graph *g, struct maze *m,
+                              int v, size_t e);
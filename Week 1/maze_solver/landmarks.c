@@ -0,0 +1,555 @@
+// Needed for mmap() and pthreads
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "landmarks.h"
+#include "maze.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Distance of a cell that a landmark does not reach. */
+#define UNREACHED UINT16_MAX
+
+/* Largest distance in a table, a landmark with longer distances divides them
+ * by its scale, see struct landmarks. */
+#define MAX_DISTANCE (UINT16_MAX - 1)
+
+/* Header of the landmark file format, followed by 'count' struct landmark
+ * and the distances as in struct landmarks, all in host byte order. The
+ * header is 64 bytes, so the rest is aligned in a mapping of the file.
+ * 'walls_hash' ties the file to the maze it was made for, see
+ * walls_hash(). */
+#define LANDMARKS_MAGIC "MAZELMK"
+#define LANDMARKS_VERSION 1
+#define LANDMARKS_BYTE_ORDER 0x01020304u
+
+struct landmarks_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t walls_hash;
+    uint32_t count;
+    uint32_t reserved32;
+    uint64_t reserved[2];
+};
+
+/* A landmark: its row-major index, row * cols + column, and the divisor of
+ * its distances. */
+struct landmark {
+    int64_t index;
+    uint32_t scale;
+    uint32_t reserved;
+};
+
+/* The distance from landmark k to the cell with row-major index i is
+ * dist[i * count + k], UNREACHED if the landmark does not reach the cell.
+ * A landmark whose distances do not fit below MAX_DISTANCE stores them
+ * divided by its 'scale', rounded down, which still gives a lower bound,
+ * see landmarks_bound(). If 'map' is not NULL 'marks' and 'dist' point
+ * into that mapping of a landmark file. */
+struct landmarks {
+    int rows;
+    int cols;
+    int count;
+    uint64_t walls_hash;
+    struct landmark *marks;
+    uint16_t *dist;
+
+    void *map;
+    size_t map_len;
+};
+
+/* A growable array of cell indices, one level of a breadth first search. */
+struct buffer {
+    int *data;
+    size_t size;
+    size_t capacity;
+};
+
+/* The breadth first search from landmark 'k' of 'l' over 'walls', see
+ * wall_bits(). 'err' is set if it failed. */
+struct landmark_bfs {
+    struct landmarks *l;
+    const uint64_t *walls;
+    int k;
+    int err;
+};
+
+/* Stores the FNV-1a hash of the walls of 'm', row by row as maze_wall_row()
+ * returns them, in 'hash'.
+ * Returns 0 if successful, 1 otherwise. */
+static int walls_hash(const struct maze *m, uint64_t *hash) {
+    size_t row_words = ((size_t) maze_cols(m) + 63) / 64;
+    uint64_t *row = malloc(row_words * sizeof(uint64_t));
+    if (row == NULL) {
+        return 1;
+    }
+    uint64_t h = UINT64_C(14695981039346656037);
+    for (int r = 0; r < maze_rows(m); r++) {
+        maze_wall_row(m, r, row);
+        for (size_t w = 0; w < row_words; w++) {
+            h = (h ^ row[w]) * UINT64_C(1099511628211);
+        }
+    }
+    free(row);
+    *hash = h;
+    return 0;
+}
+
+static bool bit_test(const uint64_t *bits, size_t i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+static void bit_set(uint64_t *bits, size_t i) {
+    bits[i / 64] |= UINT64_C(1) << (i % 64);
+}
+
+/* Returns a bitmap with bit r * cols + c set if (r, c) is a WALL or on the
+ * border, or NULL if it could not be allocated. With the border set the
+ * neighbours of every open cell are in the maze. */
+static uint64_t *wall_bits(const struct maze *m) {
+    int rows = maze_rows(m);
+    int cols = maze_cols(m);
+    size_t row_words = ((size_t) cols + 63) / 64;
+    uint64_t *row = malloc(row_words * sizeof(uint64_t));
+    uint64_t *bits = calloc(((size_t) rows * (size_t) cols + 63) / 64,
+                            sizeof(uint64_t));
+    if (row == NULL || bits == NULL) {
+        free(row);
+        free(bits);
+        return NULL;
+    }
+    for (int r = 0; r < rows; r++) {
+        maze_wall_row(m, r, row);
+        for (int c = 0; c < cols; c++) {
+            if (r == 0 || r == rows - 1 || c == 0 || c == cols - 1
+                || bit_test(row, (size_t) c)) {
+                bit_set(bits, (size_t) r * (size_t) cols + (size_t) c);
+            }
+        }
+    }
+    free(row);
+    return bits;
+}
+
+/* Returns the angle of (x, y) as a value in [0, 4) that grows with the real
+ * angle, a quarter turn per unit, without trigonometry. */
+static double diamond_angle(double y, double x) {
+    if (y == 0 && x == 0) {
+        return 0;
+    }
+    if (y >= 0) {
+        return x >= 0 ? y / (x + y) : 1 - x / (-x + y);
+    }
+    return x < 0 ? 2 - y / (-x - y) : 3 + x / (x - y);
+}
+
+static int buffer_push(struct buffer *buf, int e) {
+    if (buf->size == buf->capacity) {
+        size_t capacity = buf->capacity ? 2 * buf->capacity : 1024;
+        int *data = realloc(buf->data, capacity * sizeof(int));
+        if (data == NULL) {
+            debug_print("Could not grow level buffer\n");
+            return 1;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+    buf->data[buf->size++] = e;
+    return 0;
+}
+
+/* Sets the bits in 'bits' of every open cell connected to 'seed' with a
+ * depth first search on 'stack', the set bits stop it.
+ * Returns the number of cells set, or 0 if an error occured. */
+static size_t flood(const struct landmarks *l, uint64_t *bits, int seed,
+                    struct buffer *stack) {
+    const int deltas[N_MOVES] = { -l->cols, 1, l->cols, -1 };
+    size_t count = 1;
+    bit_set(bits, (size_t) seed);
+    stack->size = 0;
+    if (buffer_push(stack, seed)) {
+        return 0;
+    }
+    while (stack->size > 0) {
+        int i = stack->data[--stack->size];
+        for (int move = 0; move < N_MOVES; move++) {
+            int j = i + deltas[move];
+            if (bit_test(bits, (size_t) j)) {
+                continue;
+            }
+            bit_set(bits, (size_t) j);
+            count++;
+            if (buffer_push(stack, j)) {
+                return 0;
+            }
+        }
+    }
+    return count;
+}
+
+/* Sets the bits in 'largest' of 'walls' and of the open cells of the
+ * largest component, the one the landmarks are picked from: a landmark in a
+ * closed pocket bounds nothing.
+ * Returns 0 if successful, 1 otherwise. */
+static int largest_component(const struct landmarks *l, const uint64_t *walls,
+                             uint64_t *largest) {
+    size_t cells = (size_t) l->rows * (size_t) l->cols;
+    size_t words = (cells + 63) / 64;
+    struct buffer stack = { NULL, 0, 0 };
+    int seed = -1;
+    size_t seed_size = 0;
+    int err = 0;
+
+    // First the size of every component, with 'largest' as scratch
+    memcpy(largest, walls, words * sizeof(uint64_t));
+    for (size_t i = 0; i < cells && !err; i++) {
+        if (!bit_test(largest, i)) {
+            size_t size = flood(l, largest, (int) i, &stack);
+            err = size == 0;
+            if (size > seed_size) {
+                seed = (int) i;
+                seed_size = size;
+            }
+        }
+    }
+    memcpy(largest, walls, words * sizeof(uint64_t));
+    if (!err && seed >= 0) {
+        err = flood(l, largest, seed, &stack) == 0;
+    }
+    free(stack.data);
+    return err;
+}
+
+/* Picks a landmark in each of 'count' equal sectors around the center of
+ * the maze: the open cell of the largest component, see
+ * largest_component(), that is farthest from the center. Rows and columns
+ * are scaled to the same length, so the sectors of a rectangular maze are
+ * even. The row-major indices are stored in 'picked'.
+ * Returns the number of landmarks, sectors without such cells have none,
+ * or -1 if an error occured. */
+static int pick_landmarks(const struct landmarks *l, const uint64_t *walls,
+                          int count, int64_t *picked) {
+    size_t words = ((size_t) l->rows * (size_t) l->cols + 63) / 64;
+    uint64_t *largest = malloc(words * sizeof(uint64_t));
+    if (largest == NULL || largest_component(l, walls, largest)) {
+        free(largest);
+        return -1;
+    }
+
+    double farthest[MAX_LANDMARKS];
+    for (int k = 0; k < count; k++) {
+        farthest[k] = -1;
+        picked[k] = -1;
+    }
+    for (int r = 1; r < l->rows - 1; r++) {
+        double y = ((double) r + 0.5) / l->rows - 0.5;
+        for (int c = 1; c < l->cols - 1; c++) {
+            size_t i = (size_t) r * (size_t) l->cols + (size_t) c;
+            if (bit_test(walls, i) || !bit_test(largest, i)) {
+                continue;
+            }
+            double x = ((double) c + 0.5) / l->cols - 0.5;
+            int k = (int) (diamond_angle(y, x) * count / 4);
+            k = k < count ? k : count - 1;
+            double d = (y < 0 ? -y : y) + (x < 0 ? -x : x);
+            if (d > farthest[k]) {
+                farthest[k] = d;
+                picked[k] = (int64_t) i;
+            }
+        }
+    }
+    free(largest);
+
+    int n = 0;
+    for (int k = 0; k < count; k++) {
+        if (picked[k] >= 0) {
+            picked[n++] = picked[k];
+        }
+    }
+    return n;
+}
+
+/* Runs the search of 'bfs' level by level and stores the distances divided
+ * by 'scale', capped at MAX_DISTANCE.
+ * Returns the largest distance, or -1 if an error occured. */
+static int64_t bfs_pass(struct landmark_bfs *bfs, uint32_t scale) {
+    struct landmarks *l = bfs->l;
+    size_t words = ((size_t) l->rows * (size_t) l->cols + 63) / 64;
+    uint64_t *visited = malloc(words * sizeof(uint64_t));
+    struct buffer level = { NULL, 0, 0 };
+    struct buffer next = { NULL, 0, 0 };
+    int source = (int) l->marks[bfs->k].index;
+    if (visited == NULL || buffer_push(&level, source)) {
+        free(visited);
+        free(level.data);
+        return -1;
+    }
+    // Walls start out visited, so one bit test skips both
+    memcpy(visited, bfs->walls, words * sizeof(uint64_t));
+    bit_set(visited, (size_t) source);
+
+    const int deltas[N_MOVES] = { -l->cols, 1, l->cols, -1 };
+    int64_t d = 0;
+    bool err = false;
+    while (level.size > 0 && !err) {
+        int64_t value = d / scale;
+        uint16_t stored = value < MAX_DISTANCE ? (uint16_t) value
+                                               : MAX_DISTANCE;
+        for (size_t n = 0; n < level.size && !err; n++) {
+            int i = level.data[n];
+            l->dist[(size_t) i * (size_t) l->count + (size_t) bfs->k] = stored;
+            for (int move = 0; move < N_MOVES; move++) {
+                int j = i + deltas[move];
+                if (bit_test(visited, (size_t) j)) {
+                    continue;
+                }
+                bit_set(visited, (size_t) j);
+                if (buffer_push(&next, j)) {
+                    err = true;
+                    break;
+                }
+            }
+        }
+
+        struct buffer swap = level;
+        level = next;
+        next = swap;
+        next.size = 0;
+        d++;
+    }
+
+    free(visited);
+    free(level.data);
+    free(next.data);
+    return err ? -1 : d - 1;
+}
+
+/* Runs the search of landmark bfs->k. Distances that do not fit in a table
+ * are found by the first pass, which is then run again with a scale. */
+static void *landmark_bfs_worker(void *arg) {
+    struct landmark_bfs *bfs = arg;
+    int64_t longest = bfs_pass(bfs, 1);
+    if (longest > MAX_DISTANCE) {
+        uint32_t scale = (uint32_t) ((longest + MAX_DISTANCE - 1)
+                                     / MAX_DISTANCE);
+        bfs->l->marks[bfs->k].scale = scale;
+        longest = bfs_pass(bfs, scale);
+    }
+    bfs->err = longest < 0;
+    return NULL;
+}
+
+struct landmarks *landmarks_init(const struct maze *m, int count) {
+    if (count < 1 || count > MAX_LANDMARKS
+        || (size_t) maze_rows(m) * (size_t) maze_cols(m) > INT_MAX) {
+        debug_print("Invalid arguments in landmarks_init\n");
+        return NULL;
+    }
+    struct landmarks *l = calloc(1, sizeof(struct landmarks));
+    uint64_t *walls = wall_bits(m);
+    if (l == NULL || walls == NULL || walls_hash(m, &l->walls_hash)) {
+        debug_print("Could not allocate memory for landmarks\n");
+        free(walls);
+        free(l);
+        return NULL;
+    }
+    l->rows = maze_rows(m);
+    l->cols = maze_cols(m);
+
+    int64_t picked[MAX_LANDMARKS];
+    l->count = pick_landmarks(l, walls, count, picked);
+    size_t cells = (size_t) l->rows * (size_t) l->cols;
+    if (l->count > 0) {
+        l->marks = malloc((size_t) l->count * sizeof(struct landmark));
+        l->dist = malloc(cells * (size_t) l->count * sizeof(uint16_t));
+    }
+    if (l->marks == NULL || l->dist == NULL) {
+        debug_print("Could not allocate memory for landmark tables\n");
+        free(walls);
+        landmarks_cleanup(l);
+        return NULL;
+    }
+    memset(l->dist, 0xff, cells * (size_t) l->count * sizeof(uint16_t));
+
+    // One thread per landmark, a landmark whose thread can't be started is
+    // searched here
+    struct landmark_bfs bfs[MAX_LANDMARKS];
+    pthread_t threads[MAX_LANDMARKS];
+    bool started[MAX_LANDMARKS] = { false };
+    for (int k = 0; k < l->count; k++) {
+        l->marks[k] = (struct landmark) { picked[k], 1, 0 };
+        bfs[k] = (struct landmark_bfs) { l, walls, k, 0 };
+    }
+    for (int k = 1; k < l->count; k++) {
+        started[k] = pthread_create(&threads[k], NULL, landmark_bfs_worker,
+                                    &bfs[k]) == 0;
+    }
+    landmark_bfs_worker(&bfs[0]);
+    int err = bfs[0].err;
+    for (int k = 1; k < l->count; k++) {
+        if (started[k]) {
+            pthread_join(threads[k], NULL);
+        } else {
+            landmark_bfs_worker(&bfs[k]);
+        }
+        err |= bfs[k].err;
+    }
+
+    free(walls);
+    if (err) {
+        debug_print("Could not search from every landmark\n");
+        landmarks_cleanup(l);
+        return NULL;
+    }
+    return l;
+}
+
+struct landmarks *landmarks_load(const struct maze *m, const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0
+        || (size_t) st.st_size < sizeof(struct landmarks_header)) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t) st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct landmarks_header *header = map;
+    size_t cells = (size_t) maze_rows(m) * (size_t) maze_cols(m);
+    uint64_t hash = 0;
+    bool valid = memcmp(header->magic, LANDMARKS_MAGIC,
+                        sizeof(LANDMARKS_MAGIC)) == 0
+                 && header->version == LANDMARKS_VERSION
+                 && header->byte_order == LANDMARKS_BYTE_ORDER
+                 && header->rows == (uint64_t) maze_rows(m)
+                 && header->cols == (uint64_t) maze_cols(m)
+                 && header->count >= 1 && header->count <= MAX_LANDMARKS
+                 && len == sizeof(*header)
+                           + header->count * (sizeof(struct landmark)
+                                              + cells * sizeof(uint16_t))
+                 && walls_hash(m, &hash) == 0 && header->walls_hash == hash;
+    struct landmark *marks = (struct landmark *) (header + 1);
+    for (uint32_t k = 0; valid && k < header->count; k++) {
+        valid = marks[k].index >= 0 && (size_t) marks[k].index < cells
+                && marks[k].scale >= 1;
+    }
+    struct landmarks *l = valid ? malloc(sizeof(struct landmarks)) : NULL;
+    if (l == NULL) {
+        munmap(map, len);
+        return NULL;
+    }
+
+    l->rows = maze_rows(m);
+    l->cols = maze_cols(m);
+    l->count = (int) header->count;
+    l->walls_hash = hash;
+    l->marks = marks;
+    l->dist = (uint16_t *) (marks + l->count);
+    l->map = map;
+    l->map_len = len;
+    return l;
+}
+
+int landmarks_save(const struct landmarks *l, const char *filename) {
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        return 1;
+    }
+
+    struct landmarks_header header = {
+        .magic = LANDMARKS_MAGIC,
+        .version = LANDMARKS_VERSION,
+        .byte_order = LANDMARKS_BYTE_ORDER,
+        .rows = (uint64_t) l->rows,
+        .cols = (uint64_t) l->cols,
+        .walls_hash = l->walls_hash,
+        .count = (uint32_t) l->count,
+    };
+    size_t count = (size_t) l->count;
+    size_t n_dist = (size_t) l->rows * (size_t) l->cols * count;
+    int err = fwrite(&header, sizeof(header), 1, fp) != 1
+              || fwrite(l->marks, sizeof(struct landmark), count, fp) != count
+              || fwrite(l->dist, sizeof(uint16_t), n_dist, fp) != n_dist;
+    if (fclose(fp) != 0) {
+        err = 1;
+    }
+    return err;
+}
+
+void landmarks_cleanup(struct landmarks *l) {
+    if (l == NULL) {
+        debug_print("Invalid landmarks struct in landmarks_cleanup\n");
+        return;
+    }
+
+    if (l->map) {
+        munmap(l->map, l->map_len);
+    } else {
+        free(l->marks);
+        free(l->dist);
+    }
+    free(l);
+}
+
+int landmarks_count(const struct landmarks *l) {
+    return l->count;
+}
+
+void landmarks_cell(const struct landmarks *l, int k, int *r, int *c) {
+    *r = (int) (l->marks[k].index / l->cols);
+    *c = (int) (l->marks[k].index % l->cols);
+}
+
+int landmarks_bound(const struct landmarks *l, int r1, int c1, int r2,
+                    int c2) {
+    size_t count = (size_t) l->count;
+    const uint16_t *a = l->dist + ((size_t) r1 * (size_t) l->cols
+                                   + (size_t) c1) * count;
+    const uint16_t *b = l->dist + ((size_t) r2 * (size_t) l->cols
+                                   + (size_t) c2) * count;
+    int64_t bound = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (a[k] == UNREACHED || b[k] == UNREACHED) {
+            // A landmark in the component of only one of them
+            if (a[k] != b[k]) {
+                return -1;
+            }
+            continue;
+        }
+        // Both distances are rounded down by up to scale - 1
+        int64_t scale = l->marks[k].scale;
+        int64_t diff = a[k] > b[k] ? a[k] - b[k] : b[k] - a[k];
+        int64_t lower = diff * scale - (scale - 1);
+        if (lower > bound) {
+            bound = lower;
+        }
+    }
+    return (int) bound;
+}
@@ -0,0 +1,56 @@
+#include <stdint.h>
+
+/* Handle to a landmark distance oracle.
+ *
+ * A few landmark cells are picked around the edge of a maze and the distance
+ * from every landmark to every cell is stored in 16 bits. Because of the
+ * triangle inequality |d(L, t) - d(L, s)| <= d(s, t) for every landmark L,
+ * so the tables give a lower bound on the distance between any two cells
+ * (ALT: A*, landmarks and triangle inequality, Goldberg and Harrelson). The
+ * bound is admissible for A* and much tighter than the Manhattan distance in
+ * a maze, whose corridors wind.
+ *
+ * The tables take 2 bytes per cell and landmark, the distances of a cell to
+ * all landmarks are next to each other so a bound reads one cache line per
+ * cell. They can be saved next to the maze and mapped back in, so the
+ * breadth first searches are run once per maze, not once per process. */
+struct landmarks;
+
+/* Forward declaration for using a struct maze pointer in the prototypes. */
+struct maze;
+
+/* Most landmarks of one oracle. */
+#define MAX_LANDMARKS 32
+
+/* Return a pointer to the oracle of maze 'm' with up to 'count' landmarks if
+ * successful, otherwise return NULL. The landmarks are the FLOOR cells of
+ * the largest component farthest from the center in 'count' sectors around
+ * it, with one breadth first search per landmark, all in parallel. Only the
+ * walls of 'm' are used. Mazes with more than INT_MAX cells are not
+ * supported. */
+struct landmarks *landmarks_init(const struct maze *m, int count);
+
+/* Return a pointer to the oracle saved in 'filename' with
+ * landmarks_save() if successful, otherwise return NULL. The file is
+ * memory mapped. It is only accepted if it was made for a maze with the
+ * size and the walls of 'm', so a stale file is never used. */
+struct landmarks *landmarks_load(const struct maze *m, const char *filename);
+
+/* Write the oracle to 'filename'.
+ * Return 0 if successful, 1 otherwise. */
+int landmarks_save(const struct landmarks *l, const char *filename);
+
+/* Cleanup oracle. */
+void landmarks_cleanup(struct landmarks *l);
+
+/* Return the number of landmarks. */
+int landmarks_count(const struct landmarks *l);
+
+/* Store the row and column of landmark 'k' in 'r' and 'c'. */
+void landmarks_cell(const struct landmarks *l, int k, int *r, int *c);
+
+/* Return a lower bound on the number of moves from (r1, c1) to (r2, c2),
+ * both FLOOR cells, or -1 if a landmark reaches only one of them so there
+ * is no path. */
+int landmarks_bound(const struct landmarks *l, int r1, int c1, int r2,
+                    int c2);
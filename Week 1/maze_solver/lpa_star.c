@@ -0,0 +1,238 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "index_heap.h"
+#include "lpa_star.h"
+#include "maze.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+#define INF INT_MAX
+
+/* 'g' is the distance from the start as last expanded, 'rhs' the distance
+ * that follows from the neighbours' g. A cell is consistent if the two are
+ * equal, the inconsistent cells are in the open list. Both arrays are indexed
+ * with maze_index() and survive between searches. */
+struct lpa_star {
+    struct maze *m;
+    struct index_heap *open;
+    int *g;
+    int *rhs;
+    int start;
+    int goal;
+};
+
+/* Returns true if (r, c) can be entered. */
+static bool is_open(const struct maze *m, int r, int c) {
+    return maze_valid_move(m, r, c) && maze_get(m, r, c) != WALL;
+}
+
+/* Returns the key of the cell at 'index': min(g, rhs) plus the Manhattan
+ * distance to the goal, ties broken on min(g, rhs). Both parts are packed in
+ * one integer so keys compare in one step. */
+static uint64_t calc_key(const struct lpa_star *l, int index) {
+    int best = l->g[index] < l->rhs[index] ? l->g[index] : l->rhs[index];
+    if (best == INF) {
+        return UINT64_MAX;
+    }
+    int h = abs(maze_row(l->m, index) - maze_row(l->m, l->goal))
+            + abs(maze_col(l->m, index) - maze_col(l->m, l->goal));
+    return ((uint64_t) (best + h) << 32) | (uint64_t) best;
+}
+
+/* Recomputes the rhs of the cell at 'index' from its neighbours and puts it
+ * in or takes it out of the open list.
+ * Returns 0 if successful, 1 otherwise. */
+static int update_cell(struct lpa_star *l, int index) {
+    struct maze *m = l->m;
+    int r = maze_row(m, index);
+    int c = maze_col(m, index);
+
+    if (!is_open(m, r, c)) {
+        l->rhs[index] = INF;
+    } else if (index == l->start) {
+        l->rhs[index] = 0;
+    } else {
+        l->rhs[index] = INF;
+        for (int move = 0; move < N_MOVES; move++) {
+            int new_r = r + m_offsets[move][0];
+            int new_c = c + m_offsets[move][1];
+            if (!is_open(m, new_r, new_c)) {
+                continue;
+            }
+            int g = l->g[maze_index(m, new_r, new_c)];
+            if (g != INF && g + 1 < l->rhs[index]) {
+                l->rhs[index] = g + 1;
+            }
+        }
+    }
+
+    if (l->g[index] == l->rhs[index]) {
+        index_heap_remove(l->open, index);
+        return 0;
+    }
+    return index_heap_push(l->open, index, calc_key(l, index));
+}
+
+/* Updates the cell at 'index' and its neighbours.
+ * Returns 0 if successful, 1 otherwise. */
+static int update_around(struct lpa_star *l, int index, bool self) {
+    struct maze *m = l->m;
+    int r = maze_row(m, index);
+    int c = maze_col(m, index);
+
+    if (self && update_cell(l, index)) {
+        return 1;
+    }
+    for (int move = 0; move < N_MOVES; move++) {
+        int new_r = r + m_offsets[move][0];
+        int new_c = c + m_offsets[move][1];
+        if (maze_valid_move(m, new_r, new_c)
+            && update_cell(l, maze_index(m, new_r, new_c))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+struct lpa_star *lpa_star_init(struct maze *m) {
+    // Cell indices are ints here
+    if (maze_cells(m) > INT_MAX) {
+        debug_print("Maze too large for the planner\n");
+        return NULL;
+    }
+
+    struct lpa_star *l = malloc(sizeof(struct lpa_star));
+    if (l == NULL) {
+        debug_print("Could not allocate memory for planner struct\n");
+        return NULL;
+    }
+
+    size_t n_cells = maze_cells(m);
+    l->m = m;
+    l->open = index_heap_init(n_cells);
+    l->g = malloc(n_cells * sizeof(int));
+    l->rhs = malloc(n_cells * sizeof(int));
+    if (l->open == NULL || l->g == NULL || l->rhs == NULL) {
+        debug_print("Could not allocate memory for planner arrays\n");
+        lpa_star_cleanup(l);
+        return NULL;
+    }
+    for (size_t i = 0; i < n_cells; i++) {
+        l->g[i] = INF;
+        l->rhs[i] = INF;
+    }
+
+    int r, c;
+    maze_start(m, &r, &c);
+    l->start = maze_index(m, r, c);
+    maze_destination(m, &r, &c);
+    l->goal = maze_index(m, r, c);
+
+    // Only the start is inconsistent before the first search
+    if (update_cell(l, l->start)) {
+        lpa_star_cleanup(l);
+        return NULL;
+    }
+    return l;
+}
+
+void lpa_star_cleanup(struct lpa_star *l) {
+    if (l == NULL) {
+        debug_print("Invalid planner struct in lpa_star_cleanup\n");
+        return;
+    }
+
+    if (l->open) {
+        index_heap_cleanup(l->open);
+    }
+    free(l->g);
+    free(l->rhs);
+    free(l);
+}
+
+void lpa_star_stats(const struct lpa_star *l) {
+    index_heap_stats(l->open);
+}
+
+int lpa_star_toggle_walls(struct lpa_star *l, const int *rows,
+                          const int *cols, size_t n) {
+    struct maze *m = l->m;
+    for (size_t i = 0; i < n; i++) {
+        if (!maze_valid_move(m, rows[i], cols[i])) {
+            debug_print("Can not toggle a cell outside the maze\n");
+            return 1;
+        }
+        char value = maze_get(m, rows[i], cols[i]) == WALL ? FLOOR : WALL;
+        maze_set(m, rows[i], cols[i], value);
+
+        // The cell and the cells that can be entered from it change
+        if (update_around(l, maze_index(m, rows[i], cols[i]), true)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int lpa_star_solve(struct lpa_star *l) {
+    while (index_heap_top_key(l->open) < calc_key(l, l->goal)
+           || l->rhs[l->goal] != l->g[l->goal]) {
+        int u = index_heap_pop(l->open);
+        if (u == -1) {
+            debug_print("Could not pop element from open list in "
+                        "lpa_star_solve\n");
+            return -2;
+        }
+
+        if (l->g[u] > l->rhs[u]) {
+            // Overconsistent: the cell got closer, settle it
+            l->g[u] = l->rhs[u];
+            if (update_around(l, u, false)) {
+                return -2;
+            }
+        } else {
+            // Underconsistent: the cell got further away, search it again
+            l->g[u] = INF;
+            if (update_around(l, u, true)) {
+                return -2;
+            }
+        }
+    }
+
+    return l->g[l->goal] == INF ? -1 : l->g[l->goal];
+}
+
+void lpa_star_mark_path(const struct lpa_star *l) {
+    struct maze *m = l->m;
+    if (l->g[l->goal] == INF) {
+        return;
+    }
+
+    // Every cell on the path has a neighbour that is one move closer
+    int i = l->goal;
+    while (i != l->start) {
+        int r = maze_row(m, i);
+        int c = maze_col(m, i);
+        int next = -1;
+        for (int move = 0; move < N_MOVES && next == -1; move++) {
+            int new_r = r + m_offsets[move][0];
+            int new_c = c + m_offsets[move][1];
+            if (is_open(m, new_r, new_c)
+                && l->g[maze_index(m, new_r, new_c)] == l->g[i] - 1) {
+                next = maze_index(m, new_r, new_c);
+            }
+        }
+        if (next == -1) {
+            debug_print("Path broken in lpa_star_mark_path\n");
+            return;
+        }
+        i = next;
+        maze_set(m, maze_row(m, i), maze_col(m, i), PATH);
+    }
+}
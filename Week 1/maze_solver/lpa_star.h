@@ -0,0 +1,43 @@
+#include <stddef.h>
+
+/* Handle to an incremental planner.
+ *
+ * Lifelong Planning A* (Koenig, Likhachev and Furcy) keeps the distance
+ * estimates g and rhs of every cell between searches. When walls change only
+ * the cells whose distance from the start changes are searched again, so a
+ * small edit costs a small search instead of a new one. */
+struct lpa_star;
+
+/* Forward declaration for using a struct maze pointer in the prototypes. */
+struct maze;
+
+/* Return a pointer to a planner for the shortest path from the start to the
+ * destination of maze 'm' if successful, otherwise return NULL. The planner
+ * uses 'm' until it is cleaned up. Mazes with more than INT_MAX cells are
+ * not supported. */
+struct lpa_star *lpa_star_init(struct maze *m);
+
+/* Cleanup planner. */
+void lpa_star_cleanup(struct lpa_star *l);
+
+/* Print the statistics of the open list to stderr, counted over all
+ * searches. The format is: 'stats' num_of_pushes num_of_pops max_elements */
+void lpa_star_stats(const struct lpa_star *l);
+
+/* Turn the 'n' cells at rows 'rows' and columns 'cols' from WALL into FLOOR
+ * or the other way around. Border cells can not be toggled. The path is not
+ * searched again until lpa_star_solve() is called, so a batch of toggles is
+ * handled by one search.
+ * Return 0 if successful, 1 otherwise. */
+int lpa_star_toggle_walls(struct lpa_star *l, const int *rows,
+                          const int *cols, size_t n);
+
+/* Bring the shortest path up to date with the walls.
+ * Return the length of the path, -1 if there is no path and -2 if an error
+ * occured. */
+int lpa_star_solve(struct lpa_star *l);
+
+/* Mark the path found by the last lpa_star_solve() as PATH in the maze, from
+ * the start up to but not including the destination. Nothing is marked if
+ * there is no path. */
+void lpa_star_mark_path(const struct lpa_star *l);
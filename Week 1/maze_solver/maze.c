@@ -1,21 +1,99 @@
-/* Do not edit this file. */
-
 // Needed for getline()
 #define _POSIX_C_SOURCE 200809L
 
 #include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "maze.h"
 
+/* The maze has 'rows' rows of 'cols' cells. Indices are 64-bit here, so
+ * mazes with more cells than fit in an int work as well. maze_index() and
+ * friends return an int for the mazes that fit, which is cheaper in the
+ * solvers, maze_index64() and friends work for every maze.
+ *
+ * With MAZE_BYTES every cell is one character in 'data'. With MAZE_PACKED
+ * 'data' is NULL and a cell is one bit in each of the 'walls', 'visited' and
+ * 'path' bitmaps. Every row of a bitmap starts at a fresh 64-bit word, so a
+ * row is 'row_words' words long and the padding bits are walls.
+ * If 'map' is not NULL the walls bitmap points into that mapping of a binary
+ * maze file instead of being allocated.
+ *
+ * The cells of a MAZE_BYTES maze are stored in the order set by 'layout', see
+ * maze_index(). The tiled layouts pad the maze to whole tiles, 'tile_cols' is
+ * the number of tiles per row and 'cells' the number of cells in 'data'.
+ *
+ * With MAZE_EPOCH 'data' or 'walls' only holds the walls. The solver state is
+ * kept in 'stamps', one per index: a cell is VISITED if its stamp holds the
+ * current 'epoch' and the lowest bit of the stamp marks it as PATH. Bumping
+ * 'epoch' turns every cell back into a FLOOR.
+ *
+ * After maze_label_components() 'labels' holds the component of every index,
+ * NO_COMPONENT for walls. Changing a wall drops the labels again.
+ *
+ * 'costs' holds the cost of every index minus one in 4 bits, see
+ * maze_costs(). It is NULL as long as every cell costs 1, so mazes without
+ * terrain do not pay for it. */
 struct maze {
-    int n;
-    int start_index;
-    int finish_index;
+    int rows;
+    int cols;
+    int64_t start_index;
+    int64_t finish_index;
     char *data;
+
+    int flags;
+    int layout;
+    int tile_cols;
+    size_t cells;
+    size_t row_words;
+    uint64_t *walls;
+    uint64_t *visited;
+    uint64_t *path;
+
+    void *map;
+    size_t map_len;
+
+    uint16_t *stamps;
+    uint16_t epoch;
+
+    uint32_t *labels;
+
+    uint8_t *costs;
+};
+
+/* Largest epoch that fits in a stamp next to the PATH bit. */
+#define MAX_EPOCH (UINT16_MAX >> 1)
+
+/* Component label of walls, border cells and padding cells. */
+#define NO_COMPONENT UINT32_MAX
+
+/* Header of the binary maze format, followed by the walls bitmap in the
+ * MAZE_PACKED layout: 'rows' rows of 'row_words' 64-bit words in host byte
+ * order. The header is 64 bytes, so the payload in a mapping of the file is
+ * aligned for 64-bit access. Version 1 files only have square mazes and
+ * leave 'cols' zero, it is then the same as 'rows'. */
+#define MAZE_BIN_MAGIC "MAZEBIN"
+#define MAZE_BIN_VERSION 2
+#define MAZE_BIN_BYTE_ORDER 0x01020304u
+
+struct maze_bin_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t rows;
+    uint64_t row_words;
+    uint64_t start_index;
+    uint64_t finish_index;
+    uint64_t cols;
+    uint64_t reserved;
 };
 
 /* Move offsets: (row, column) We can only move in four directions.
@@ -26,63 +104,473 @@ struct maze {
  */
 int m_offsets[N_MOVES][2] = { { -1, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 } };
 
-/* Creates a square maze structure of 'n' rows by 'n' columns filled with
- * walls. maze_init() is not part of the maze interface, it is a helper
- * function for maze_read().
- * Returns a pointer to the initialized maze or NULL if an error occured. */
-struct maze *maze_init(int n) {
-    if (n <= 0) {
+/* Tiles of the MAZE_TILED and MAZE_MORTON layouts are TILE x TILE cells, 4 kB
+ * for a MAZE_BYTES maze, so a tile is one page and its rows share cache lines
+ * with the rows above and below. */
+#define TILE_BITS 6
+#define TILE (1 << TILE_BITS)
+#define TILE_MASK (TILE - 1)
+
+/* Spreads the low 8 bits of 'x' to the even bits of the result. */
+static unsigned spread_bits(unsigned x) {
+    x = (x | (x << 4)) & 0x0f0f;
+    x = (x | (x << 2)) & 0x3333;
+    x = (x | (x << 1)) & 0x5555;
+    return x;
+}
+
+/* Inverse of spread_bits(): gathers the even bits of 'x'. */
+static unsigned gather_bits(unsigned x) {
+    x &= 0x5555;
+    x = (x | (x >> 1)) & 0x3333;
+    x = (x | (x >> 2)) & 0x0f0f;
+    x = (x | (x >> 4)) & 0x00ff;
+    return x;
+}
+
+/* Allocates the bitmaps of a MAZE_PACKED maze, all cells walls. The walls
+ * bitmap is only allocated if 'alloc_walls' is true.
+ * Returns 0 if successful, 1 otherwise. */
+static int init_bitmaps(struct maze *m, bool alloc_walls) {
+    m->row_words = ((size_t) m->cols + 63) / 64;
+    size_t words = m->row_words * (size_t) m->rows;
+    if (alloc_walls) {
+        m->walls = malloc(words * sizeof(uint64_t));
+    }
+    if (!(m->flags & MAZE_EPOCH)) {
+        m->visited = calloc(words, sizeof(uint64_t));
+        m->path = calloc(words, sizeof(uint64_t));
+    }
+    if ((alloc_walls && !m->walls)
+        || (!(m->flags & MAZE_EPOCH) && (!m->visited || !m->path))) {
+        free(m->walls);
+        free(m->visited);
+        free(m->path);
+        return 1;
+    }
+    if (alloc_walls) {
+        memset(m->walls, 0xff, words * sizeof(uint64_t));
+    }
+    return 0;
+}
+
+/* Creates a maze as described for maze_init(). If 'alloc_walls' is false a
+ * MAZE_PACKED maze is created without a walls bitmap, the caller provides
+ * one. */
+static struct maze *maze_create(int rows, int cols, int flags,
+                                bool alloc_walls) {
+    if (rows <= 0 || cols <= 0) {
         return NULL;
     }
     struct maze *m = malloc(sizeof(struct maze));
     if (!m) {
         return NULL;
     }
-    m->n = n;
-    m->data = calloc(1, (size_t)(m->n * m->n * (int) sizeof(char)));
-    if (!m->data) {
-        free(m);
-        return NULL;
+    m->rows = rows;
+    m->cols = cols;
+    m->flags = flags;
+    m->layout = flags & (MAZE_TILED | MAZE_MORTON);
+    if (flags & MAZE_PACKED) {
+        // The bitmaps are always row-major
+        m->layout = MAZE_BYTES;
+    } else if (m->layout == (MAZE_TILED | MAZE_MORTON)) {
+        m->layout = MAZE_MORTON;
+    }
+    m->tile_cols = (cols + TILE - 1) / TILE;
+    if (m->layout == MAZE_BYTES) {
+        m->cells = (size_t) rows * (size_t) cols;
+    } else {
+        size_t tile_rows = ((size_t) rows + TILE - 1) / TILE;
+        m->cells = tile_rows * (size_t) m->tile_cols * TILE * TILE;
+    }
+    m->data = NULL;
+    m->row_words = 0;
+    m->walls = m->visited = m->path = NULL;
+    m->map = NULL;
+    m->map_len = 0;
+    m->stamps = NULL;
+    m->epoch = 1;
+    m->labels = NULL;
+    m->costs = NULL;
+
+    if (flags & MAZE_EPOCH) {
+        m->stamps = calloc(m->cells, sizeof(uint16_t));
+        if (!m->stamps) {
+            free(m);
+            return NULL;
+        }
+    }
+
+    if (flags & MAZE_PACKED) {
+        if (init_bitmaps(m, alloc_walls)) {
+            free(m->stamps);
+            free(m);
+            return NULL;
+        }
+    } else {
+        m->data = calloc(1, m->cells * sizeof(char));
+        if (!m->data) {
+            free(m->stamps);
+            free(m);
+            return NULL;
+        }
+        memset(m->data, WALL, m->cells);
     }
-    memset(m->data, WALL, (size_t)(m->n * m->n));
 
     // And finally set the default start and finish locations.
-    m->start_index = maze_index(m, 1, 1); // upper left
-    m->finish_index = maze_index(m, maze_size(m) - 2,
-                                 maze_size(m) - 2); // lower right
+    m->start_index = maze_index64(m, 1, 1); // upper left
+    m->finish_index = maze_index64(m, rows - 2, cols - 2); // lower right
     return m;
 }
 
+struct maze *maze_init(int n, int flags) {
+    return maze_create(n, n, flags, true);
+}
+
+struct maze *maze_init_rect(int rows, int cols, int flags) {
+    return maze_create(rows, cols, flags, true);
+}
+
 void maze_cleanup(struct maze *m) {
     free(m->data);
+    if (m->map) {
+        munmap(m->map, m->map_len);
+    } else {
+        free(m->walls);
+    }
+    free(m->visited);
+    free(m->path);
+    free(m->stamps);
+    free(m->labels);
+    free(m->costs);
     free(m);
 }
 
+/* Bit helpers for the MAZE_PACKED bitmaps. */
+static bool bit_get(const uint64_t *bits, size_t word, int bit) {
+    return (bits[word] >> bit) & 1;
+}
+
+static void bit_put(uint64_t *bits, size_t word, int bit, bool value) {
+    if (value) {
+        bits[word] |= UINT64_C(1) << bit;
+    } else {
+        bits[word] &= ~(UINT64_C(1) << bit);
+    }
+}
+
+/* maze_get() for a MAZE_EPOCH maze. */
+static char epoch_get(const struct maze *m, int r, int c) {
+    int64_t index = maze_index64(m, r, c);
+    bool wall;
+    if (!m->data) {
+        wall = bit_get(m->walls, (size_t) r * m->row_words + (size_t) c / 64,
+                       c % 64);
+    } else {
+        wall = m->data[index] == WALL;
+    }
+
+    uint16_t stamp = m->stamps[index];
+    if (wall) {
+        return WALL;
+    } else if ((stamp >> 1) != m->epoch) {
+        return FLOOR;
+    }
+    return (stamp & 1) ? PATH : VISITED;
+}
+
+/* maze_set() for a MAZE_EPOCH maze. */
+static void epoch_set(struct maze *m, int r, int c, char value) {
+    int64_t index = maze_index64(m, r, c);
+    if (!m->data) {
+        bit_put(m->walls, (size_t) r * m->row_words + (size_t) c / 64, c % 64,
+                value == WALL);
+    } else {
+        m->data[index] = value == WALL ? WALL : FLOOR;
+    }
+
+    if (value == VISITED || value == TO_VISIT) {
+        m->stamps[index] = (uint16_t) (m->epoch << 1);
+    } else if (value == PATH) {
+        m->stamps[index] = (uint16_t) (m->epoch << 1 | 1);
+    } else {
+        m->stamps[index] = 0;
+    }
+}
+
 char maze_get(const struct maze *m, int r, int c) {
-    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
-    return m->data[r * m->n + c];
+    assert(r >= 0 && r < m->rows && c >= 0 && c < m->cols);
+    if (m->stamps) {
+        return epoch_get(m, r, c);
+    }
+    if (!m->data) {
+        size_t word = (size_t) r * m->row_words + (size_t) c / 64;
+        int bit = c % 64;
+        if (bit_get(m->walls, word, bit)) {
+            return WALL;
+        } else if (bit_get(m->path, word, bit)) {
+            return PATH;
+        } else if (bit_get(m->visited, word, bit)) {
+            return VISITED;
+        }
+        return FLOOR;
+    }
+    return m->data[maze_index64(m, r, c)];
 }
 
 void maze_set(struct maze *m, int r, int c, char value) {
-    assert(r >= 0 && r < m->n && c >= 0 && c < m->n);
-    m->data[r * m->n + c] = value;
+    assert(r >= 0 && r < m->rows && c >= 0 && c < m->cols);
+    if (m->labels && (value == WALL) != (maze_get(m, r, c) == WALL)) {
+        // The components may have changed
+        free(m->labels);
+        m->labels = NULL;
+    }
+    if (m->stamps) {
+        epoch_set(m, r, c, value);
+        return;
+    }
+    if (!m->data) {
+        size_t word = (size_t) r * m->row_words + (size_t) c / 64;
+        int bit = c % 64;
+        bit_put(m->walls, word, bit, value == WALL);
+        bit_put(m->visited, word, bit, value == VISITED || value == TO_VISIT);
+        bit_put(m->path, word, bit, value == PATH);
+        return;
+    }
+    m->data[maze_index64(m, r, c)] = value;
 }
 
-void maze_print(const struct maze *m, bool blocks) {
-    for (int r = 0; r < m->n; r++) {
-        for (int c = 0; c < m->n; c++) {
-            if (blocks && maze_get(m, r, c) == WALL) {
-                printf("\u2588");
-            } else if (maze_at_start(m, r, c)) {
-                putchar(START);
-            } else if (maze_at_destination(m, r, c)) {
-                putchar(FINISH);
+void maze_reset(struct maze *m) {
+    if (m->stamps) {
+        // Stamps of old epochs read as FLOOR, until the counter wraps around
+        if (m->epoch == MAX_EPOCH) {
+            memset(m->stamps, 0, m->cells * sizeof(uint16_t));
+            m->epoch = 0;
+        }
+        m->epoch++;
+    } else if (!m->data) {
+        size_t words = m->row_words * (size_t) m->rows;
+        memset(m->visited, 0, words * sizeof(uint64_t));
+        memset(m->path, 0, words * sizeof(uint64_t));
+    } else {
+        for (size_t i = 0; i < m->cells; i++) {
+            if (m->data[i] != WALL) {
+                m->data[i] = FLOOR;
+            }
+        }
+    }
+}
+
+/* Upper bound on the number of threads used to read or render a maze. */
+#define MAX_BAND_THREADS 64
+
+/* Rendered bytes per round of maze_print() and maze_output_ppm(), so huge
+ * mazes are written in a few large writes without a buffer for the whole
+ * image. */
+#define RENDER_CHUNK (1 << 24)
+
+/* Returns the number of threads to split 'rows' rows over. */
+static int band_count(int rows) {
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    if (n_threads > MAX_BAND_THREADS) {
+        n_threads = MAX_BAND_THREADS;
+    }
+    if (n_threads > rows) {
+        n_threads = rows;
+    }
+    return (int) n_threads;
+}
+
+/* Runs 'worker' on each of the 'n' argument structs of 'size' bytes in
+ * 'args'. Band 0 runs on the calling thread, the others on threads of their
+ * own. If a thread can't be started its band runs here as well. */
+static void run_bands(void *(*worker)(void *), void *args, size_t size,
+                      int n) {
+    char *arg = args;
+    pthread_t threads[MAX_BAND_THREADS];
+    bool started[MAX_BAND_THREADS] = { false };
+    for (int t = 1; t < n; t++) {
+        started[t] = pthread_create(&threads[t], NULL, worker,
+                                    arg + (size_t) t * size) == 0;
+    }
+    worker(arg);
+    for (int t = 1; t < n; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            worker(arg + (size_t) t * size);
+        }
+    }
+}
+
+/* Stores the characters of row 'r' in 'out' as maze_get() returns them. */
+static void get_row(const struct maze *m, int r, char *out) {
+    if (m->data && !m->stamps && m->layout == MAZE_BYTES) {
+        memcpy(out, m->data + (size_t) r * (size_t) m->cols, (size_t) m->cols);
+    } else if (!m->data && !m->stamps) {
+        const uint64_t *walls = m->walls + (size_t) r * m->row_words;
+        const uint64_t *path = m->path + (size_t) r * m->row_words;
+        const uint64_t *visited = m->visited + (size_t) r * m->row_words;
+        for (int c = 0; c < m->cols; c++) {
+            size_t word = (size_t) c / 64;
+            int bit = c % 64;
+            out[c] = bit_get(walls, word, bit) ? WALL
+                     : bit_get(path, word, bit) ? PATH
+                     : bit_get(visited, word, bit) ? VISITED : FLOOR;
+        }
+    } else {
+        for (int c = 0; c < m->cols; c++) {
+            out[c] = maze_get(m, r, c);
+        }
+    }
+}
+
+/* Stand-ins for the start and destination in a row from get_row(), they are
+ * no maze characters so the color table can tell them apart. */
+#define START_CELL '\1'
+#define FINISH_CELL '\2'
+
+/* Replaces the start and destination in row 'r' from get_row() by 'start'
+ * and 'finish', unless 'keep_walls' is set and the cell is a WALL. */
+static void mark_ends(const struct maze *m, int r, char *row, char start,
+                      char finish, bool keep_walls) {
+    int64_t index[2] = { m->start_index, m->finish_index };
+    char value[2] = { start, finish };
+    for (int k = 0; k < 2; k++) {
+        if (maze_row64(m, index[k]) == r) {
+            int c = maze_col64(m, index[k]);
+            if (!keep_walls || row[c] != WALL) {
+                row[c] = value[k];
+            }
+        }
+    }
+}
+
+/* Shows the FLOOR cells of row 'r' from get_row() that cost more than 1 as
+ * the digit of their cost, as in the maze text. */
+static void show_costs(const struct maze *m, int r, char *row) {
+    for (int c = 0; c < m->cols; c++) {
+        int cost = maze_cost(m, r, c);
+        if (row[c] == FLOOR && cost > 1) {
+            row[c] = (char) ('0' + cost);
+        }
+    }
+}
+
+/* Rows [first_row, last_row) rendered by one thread of maze_print() or
+ * maze_output_ppm() into 'out'. 'rgb' is the color of every character for a
+ * ppm image, NULL for text. 'cells' holds one row from get_row(). */
+struct render_band {
+    const struct maze *m;
+    const unsigned char (*rgb)[3];
+    bool blocks;
+    int first_row;
+    int last_row;
+    char *cells;
+    char *out;
+    size_t len;
+};
+
+static void *render_band_worker(void *arg) {
+    struct render_band *band = arg;
+    const struct maze *m = band->m;
+    char *out = band->out;
+
+    for (int r = band->first_row; r < band->last_row; r++) {
+        get_row(m, r, band->cells);
+        if (band->rgb) {
+            mark_ends(m, r, band->cells, START_CELL, FINISH_CELL, false);
+            for (int c = 0; c < m->cols; c++) {
+                memcpy(out, band->rgb[(unsigned char) band->cells[c]], 3);
+                out += 3;
+            }
+            continue;
+        }
+
+        if (m->costs) {
+            show_costs(m, r, band->cells);
+        }
+        mark_ends(m, r, band->cells, START, FINISH, band->blocks);
+        for (int c = 0; c < m->cols; c++) {
+            if (band->blocks && band->cells[c] == WALL) {
+                memcpy(out, "\u2588", 3);
+                out += 3;
             } else {
-                putchar(maze_get(m, r, c));
+                *out++ = band->cells[c];
+            }
+        }
+        *out++ = '\n';
+    }
+    band->len = (size_t) (out - band->out);
+    return NULL;
+}
+
+/* Renders every row of 'm' in row bands on parallel threads and writes them
+ * to 'fp', as ppm pixels with the colors in 'rgb' or as text if 'rgb' is
+ * NULL.
+ * Returns 0 if successful, 1 otherwise. */
+static int render(const struct maze *m, FILE *fp,
+                  const unsigned char (*rgb)[3], bool blocks) {
+    size_t row_bytes = 3 * (size_t) m->cols + (rgb ? 0 : 1);
+    size_t chunk_rows = RENDER_CHUNK / row_bytes;
+    if (chunk_rows < 1) {
+        chunk_rows = 1;
+    } else if (chunk_rows > (size_t) m->rows) {
+        chunk_rows = (size_t) m->rows;
+    }
+    int n_threads = band_count((int) chunk_rows);
+    int band_rows = ((int) chunk_rows + n_threads - 1) / n_threads;
+
+    int status = 0;
+    struct render_band bands[MAX_BAND_THREADS];
+    for (int t = 0; t < n_threads; t++) {
+        bands[t] = (struct render_band) {
+            .m = m,
+            .rgb = rgb,
+            .blocks = blocks,
+            .cells = malloc((size_t) m->cols),
+            .out = malloc((size_t) band_rows * row_bytes),
+        };
+        if (!bands[t].cells || !bands[t].out) {
+            status = 1;
+        }
+    }
+
+    for (int first = 0; status == 0 && first < m->rows;
+         first += (int) chunk_rows) {
+        int last = (size_t) (m->rows - first) > chunk_rows
+                   ? first + (int) chunk_rows : m->rows;
+        for (int t = 0; t < n_threads; t++) {
+            int band_first = first + t * band_rows;
+            bands[t].first_row = band_first < last ? band_first : last;
+            bands[t].last_row = band_first + band_rows < last
+                                ? band_first + band_rows : last;
+        }
+        run_bands(render_band_worker, bands, sizeof(struct render_band),
+                  n_threads);
+
+        // One large write per band, in row order
+        for (int t = 0; t < n_threads; t++) {
+            if (fwrite(bands[t].out, 1, bands[t].len, fp) != bands[t].len) {
+                status = 1;
+                break;
             }
         }
-        printf("\n");
     }
+
+    for (int t = 0; t < n_threads; t++) {
+        free(bands[t].cells);
+        free(bands[t].out);
+    }
+    return status;
+}
+
+void maze_print(const struct maze *m, bool blocks) {
+    fflush(stdout);
+    render(m, stdout, NULL, blocks);
     printf("\n");
 }
 
@@ -94,6 +582,18 @@ static void set_rgb(unsigned char color[], unsigned char r, unsigned char g,
     color[2] = b;
 }
 
+/* Fills 'rgb' with the ppm color of every character of a row from get_row()
+ * with the start and destination marked by mark_ends(). Every character
+ * that is not listed is black. */
+static void init_colors(unsigned char rgb[256][3]) {
+    memset(rgb, 0, 256 * 3);
+    set_rgb(rgb[(unsigned char) START_CELL], 0, 255, 0); // green
+    set_rgb(rgb[(unsigned char) FINISH_CELL], 255, 165, 0); // orange
+    set_rgb(rgb[(unsigned char) WALL], 255, 255, 255); // white
+    set_rgb(rgb[(unsigned char) PATH], 255, 0, 0); // red
+    set_rgb(rgb[(unsigned char) VISITED], 128, 128, 128); // gray
+}
+
 /* To view the ppm file use a viewer such as geeqie or eog. Zoom in and
  * disable interpolation.
  * The maze cells are colored as follows:
@@ -112,124 +612,913 @@ int maze_output_ppm(const struct maze *m, const char *filename) {
     }
 
     /* Write header */
-    fprintf(fp, "P6\n%d %d\n255\n", (int) m->n, (int) m->n);
+    fprintf(fp, "P6\n%d %d\n255\n", m->cols, m->rows);
 
     /* Write RGB color data for every cell location. */
-    for (int r = 0; r < m->n; r++) {
-        for (int c = 0; c < m->n; c++) {
-            unsigned char color[3] = { 0, 0, 0 }; // black
-            if (maze_at_start(m, r, c)) {
-                set_rgb(color, 0, 255, 0); // green
-            } else if (maze_at_destination(m, r, c)) {
-                set_rgb(color, 255, 165, 0); // orange
-            } else if (maze_get(m, r, c) == WALL) {
-                set_rgb(color, 255, 255, 255); // white
-            } else if (maze_get(m, r, c) == PATH) {
-                set_rgb(color, 255, 0, 0); // red
-            } else if (maze_get(m, r, c) == VISITED) {
-                set_rgb(color, 128, 128, 128); // gray
+    unsigned char rgb[256][3];
+    init_colors(rgb);
+    int status = render(m, fp, (const unsigned char (*)[3]) rgb, false);
+    if (fclose(fp) != 0) {
+        status = 1;
+    }
+    return status;
+}
+
+/* Output rows [first_row, last_row) of a thumbnail of 'width' by 'height'
+ * pixels, rendered by one thread of maze_output_thumbnail() into 'out'.
+ * 'gray' and 'marks' have room for one output row: the summed gray level of
+ * the cells of every pixel and which of the start, destination and path they
+ * hold. */
+struct thumbnail_band {
+    const struct maze *m;
+    const unsigned char (*rgb)[3];
+    int width;
+    int height;
+    int first_row;
+    int last_row;
+    char *cells;
+    uint64_t *gray;
+    unsigned char *marks;
+    unsigned char *out;
+};
+
+/* Bits in the 'marks' of a thumbnail pixel, the lowest set bit decides the
+ * color of the pixel. */
+#define MARK_START 0x1
+#define MARK_FINISH 0x2
+#define MARK_PATH 0x4
+
+static void *thumbnail_band_worker(void *arg) {
+    struct thumbnail_band *band = arg;
+    const struct maze *m = band->m;
+    int width = band->width;
+
+    for (int y = band->first_row; y < band->last_row; y++) {
+        int first = (int) ((long) y * m->rows / band->height);
+        int last = (int) ((long) (y + 1) * m->rows / band->height);
+        memset(band->gray, 0, (size_t) width * sizeof(uint64_t));
+        memset(band->marks, 0, (size_t) width);
+
+        for (int r = first; r < last; r++) {
+            get_row(m, r, band->cells);
+            mark_ends(m, r, band->cells, START_CELL, FINISH_CELL, false);
+            for (int c = 0; c < m->cols; c++) {
+                int x = (int) ((long) c * width / m->cols);
+                char cell = band->cells[c];
+                band->gray[x] += band->rgb[(unsigned char) cell][0];
+                band->marks[x] |= cell == START_CELL ? MARK_START
+                                  : cell == FINISH_CELL ? MARK_FINISH
+                                  : cell == PATH ? MARK_PATH : 0;
+            }
+        }
+
+        // Every pixel covers the same number of cells up to rounding
+        unsigned char *out = band->out + (size_t) (y - band->first_row)
+                             * (size_t) width * 3;
+        for (int x = 0; x < width; x++) {
+            int cols = (int) ((long) (x + 1) * m->cols / width)
+                       - (int) ((long) x * m->cols / width);
+            uint64_t cells = (uint64_t) (last - first) * (uint64_t) cols;
+            unsigned char level = (unsigned char) (band->gray[x] / cells);
+            unsigned char marks = band->marks[x];
+            if (marks & MARK_START) {
+                memcpy(out, band->rgb[(unsigned char) START_CELL], 3);
+            } else if (marks & MARK_FINISH) {
+                memcpy(out, band->rgb[(unsigned char) FINISH_CELL], 3);
+            } else if (marks & MARK_PATH) {
+                memcpy(out, band->rgb[(unsigned char) PATH], 3);
+            } else {
+                set_rgb(out, level, level, level);
             }
-            fwrite(color, 1, 3, fp);
+            out += 3;
         }
     }
-    fclose(fp);
-    return 0;
+    return NULL;
 }
 
-/* Detect and set start and finish locations in maze 'm'. */
-static void check_for_start_and_dest(struct maze *m, int r, int c, char val) {
-    if (val == START) {
-        m->start_index = maze_index(m, r, c);
-    } else if (val == FINISH) {
-        m->finish_index = maze_index(m, r, c);
+int maze_output_thumbnail(const struct maze *m, const char *filename,
+                          int size) {
+    if (size <= 0 || (size >= m->rows && size >= m->cols)) {
+        return maze_output_ppm(m, filename);
     }
-}
 
-/* Set 'val' character in 'm' at position 'r', 'c'. */
-static void set_value(struct maze *m, int r, int c, char val) {
-    if (val == WALL) {
-        maze_set(m, r, c, WALL);
+    // The longer side gets 'size' pixels, the other one keeps the aspect
+    int width = size;
+    int height = size;
+    if (m->rows > m->cols) {
+        width = (int) ((long) size * m->cols / m->rows);
     } else {
-        /* Should overwrite start and finish markers with FLOOR. */
-        maze_set(m, r, c, FLOOR);
+        height = (int) ((long) size * m->rows / m->cols);
+    }
+    width = width > 0 ? width : 1;
+    height = height > 0 ? height : 1;
+
+    unsigned char rgb[256][3];
+    init_colors(rgb);
+    int n_threads = band_count(height);
+    unsigned char *image = malloc((size_t) width * (size_t) height * 3);
+    struct thumbnail_band bands[MAX_BAND_THREADS];
+    int status = image ? 0 : 1;
+    for (int t = 0; t < n_threads; t++) {
+        bands[t] = (struct thumbnail_band) {
+            .m = m,
+            .rgb = (const unsigned char (*)[3]) rgb,
+            .width = width,
+            .height = height,
+            .first_row = (int) ((long) height * t / n_threads),
+            .last_row = (int) ((long) height * (t + 1) / n_threads),
+            .cells = malloc((size_t) m->cols),
+            .gray = malloc((size_t) width * sizeof(uint64_t)),
+            .marks = malloc((size_t) width),
+        };
+        if (!bands[t].cells || !bands[t].gray || !bands[t].marks) {
+            status = 1;
+        } else if (image) {
+            bands[t].out = image + (size_t) bands[t].first_row
+                           * (size_t) width * 3;
+        }
+    }
+
+    if (status == 0) {
+        run_bands(thumbnail_band_worker, bands,
+                  sizeof(struct thumbnail_band), n_threads);
+
+        FILE *fp = fopen(filename, "wb");
+        if (!fp) {
+            fprintf(stderr, "Cannot open file %s\n", filename);
+            status = 1;
+        } else {
+            fprintf(fp, "P6\n%d %d\n255\n", width, height);
+            size_t len = (size_t) width * (size_t) height * 3;
+            if (fwrite(image, 1, len, fp) != len) {
+                status = 1;
+            }
+            if (fclose(fp) != 0) {
+                status = 1;
+            }
+        }
+    }
+
+    for (int t = 0; t < n_threads; t++) {
+        free(bands[t].cells);
+        free(bands[t].gray);
+        free(bands[t].marks);
     }
+    free(image);
+    return status;
 }
 
-struct maze *maze_read(void) {
-    char *buf = NULL;
-    size_t bufsize = 0;
+/* Rows [first_row, last_row) of the text in 'text' that one thread of
+ * maze_read_file() translates into the maze. The last start and finish
+ * markers the thread sees are returned in 'start_index' and 'finish_index'
+ * (-1 if none), 'terrain' is set if the rows hold a cost, see has_costs(). */
+struct read_band {
+    struct maze *m;
+    const char *text;
+    int first_row;
+    int last_row;
+    int64_t start_index;
+    int64_t finish_index;
+    bool terrain;
+};
+
+/* Translate one text row into row 'r' of a MAZE_BYTES maze. */
+static void translate_row_bytes(struct maze *m, int r, const char *line) {
+    if (m->layout != MAZE_BYTES) {
+        for (int c = 0; c < m->cols; c++) {
+            m->data[maze_index64(m, r, c)] = line[c] == WALL ? WALL : FLOOR;
+        }
+        return;
+    }
+    char *out = m->data + (size_t) r * (size_t) m->cols;
+    for (int c = 0; c < m->cols; c++) {
+        out[c] = line[c] == WALL ? WALL : FLOOR;
+    }
+}
+
+/* Packs the 'n' characters of 'line' into 'row_words' words of wall bits.
+ * The padding bits after the last cell are set (walls). */
+static void pack_row(const char *line, int n, uint64_t *out,
+                     size_t row_words) {
+    for (size_t w = 0; w < row_words; w++) {
+        int first = (int) w * 64;
+        int count = n - first < 64 ? n - first : 64;
+        uint64_t bits = count < 64 ? ~UINT64_C(0) << count : 0;
+        for (int b = 0; b < count; b++) {
+            bits |= (uint64_t) (line[first + b] == WALL) << b;
+        }
+        out[w] = bits;
+    }
+}
+
+/* Translate one text row into row 'r' of a MAZE_PACKED maze. Rows start at a
+ * fresh word, so threads working on different rows never share a word. */
+static void translate_row_packed(struct maze *m, int r, const char *line) {
+    pack_row(line, m->cols, m->walls + (size_t) r * m->row_words,
+             m->row_words);
+}
+
+/* Returns the column of the last 'marker' in the 'n' cells of 'line', or -1
+ * if there is none. Markers are rare, so memchr skips over most of the row. */
+static int last_marker(const char *line, int n, char marker) {
+    int last = -1;
+    const char *p = line;
+    const char *end = line + n;
+    while ((p = memchr(p, marker, (size_t) (end - p))) != NULL) {
+        last = (int) (p - line);
+        p++;
+    }
+    return last;
+}
+
+/* Returns true if one of the 'n' cells of 'line' is a digit from 2 to
+ * MAX_COST, a cell that costs more than a FLOOR. */
+static bool has_costs(const char *line, int n) {
+    bool found = false;
+    for (int c = 0; c < n; c++) {
+        found |= (unsigned char) (line[c] - '2') < MAX_COST - 1;
+    }
+    return found;
+}
+
+/* Sets the cost of every cell of rows [first_row, last_row) of 'text' that
+ * has_costs() finds.
+ * Returns 0 if successful, 1 otherwise. */
+static int read_costs(struct maze *m, const char *text, int first_row,
+                      int last_row) {
+    size_t stride = (size_t) m->cols + 1;
+    for (int r = first_row; r < last_row; r++) {
+        const char *line = text + (size_t) r * stride;
+        for (int c = 0; c < m->cols; c++) {
+            if (has_costs(line + c, 1)
+                && maze_set_cost(m, r, c, line[c] - '0')) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
 
-    /* Read one line to get number of columns so we can allocate the maze. */
-    int ncols = (int) getline(&buf, &bufsize, stdin) - 1;
-    struct maze *m = maze_init(ncols);
+static void *read_band_worker(void *arg) {
+    struct read_band *band = arg;
+    struct maze *m = band->m;
+    size_t stride = (size_t) m->cols + 1; // cols cells + newline
+
+    for (int r = band->first_row; r < band->last_row; r++) {
+        const char *line = band->text + (size_t) r * stride;
+        if (m->data) {
+            translate_row_bytes(m, r, line);
+        } else {
+            translate_row_packed(m, r, line);
+        }
+
+        int c = last_marker(line, m->cols, START);
+        if (c >= 0) {
+            band->start_index = maze_index64(m, r, c);
+        }
+        c = last_marker(line, m->cols, FINISH);
+        if (c >= 0) {
+            band->finish_index = maze_index64(m, r, c);
+        }
+        if (!band->terrain) {
+            band->terrain = has_costs(line, m->cols);
+        }
+    }
+    return NULL;
+}
+
+/* Finds the maze in 'text': the first line sets the number of columns,
+ * which is stored in 'cols', and every row up to the end of the text or an
+ * empty line must have that length.
+ * Returns the number of rows or -1 if there is no maze. */
+static int scan_rows(const char *text, size_t len, int *cols) {
+    const char *nl = memchr(text, '\n', len);
+    if (!nl || nl == text || nl - text > INT32_MAX) {
+        return -1;
+    }
+    size_t ncols = (size_t) (nl - text);
+    size_t stride = ncols + 1;
+
+    // memchr is vectorized in the C library, so every row is one scan.
+    size_t rows = 0;
+    const char *line = text;
+    while ((size_t) (line - text) + stride <= len
+           && memchr(line, '\n', stride) == line + ncols) {
+        if (rows == INT32_MAX) {
+            return -1;
+        }
+        rows++;
+        line += stride;
+    }
+
+    // The rows end at the end of the text or at an empty line, a row of
+    // another length is an error
+    if ((size_t) (line - text) < len && *line != '\n') {
+        return -1;
+    }
+
+    *cols = (int) ncols;
+    return (int) rows;
+}
+
+/* Builds a maze from the 'len' bytes of maze text in 'text', translating
+ * the rows in parallel bands.
+ * Returns a pointer to the maze or NULL if an error occured. */
+static struct maze *parse_text(const char *text, size_t len, int flags) {
+    int cols;
+    int rows = scan_rows(text, len, &cols);
+    struct maze *m = rows > 0 ? maze_init_rect(rows, cols, flags) : NULL;
     if (!m) {
-        free(buf);
         return NULL;
     }
 
-    int row = 0;
-    do {
-        if (row == ncols) { /* Error: more rows than columns */
+    int n_threads = band_count(rows);
+    struct read_band bands[MAX_BAND_THREADS];
+    for (int t = 0; t < n_threads; t++) {
+        bands[t] = (struct read_band) {
+            .m = m,
+            .text = text,
+            .first_row = (int) ((long) rows * t / n_threads),
+            .last_row = (int) ((long) rows * (t + 1) / n_threads),
+            .start_index = -1,
+            .finish_index = -1,
+            .terrain = false,
+        };
+    }
+    run_bands(read_band_worker, bands, sizeof(struct read_band), n_threads);
+
+    // Bands are in row order, so the last marker found wins
+    for (int t = 0; t < n_threads; t++) {
+        if (bands[t].start_index >= 0) {
+            m->start_index = bands[t].start_index;
+        }
+        if (bands[t].finish_index >= 0) {
+            m->finish_index = bands[t].finish_index;
+        }
+    }
+
+    // Costs share bytes across rows, so the bands with terrain are read
+    // again here, one after the other
+    for (int t = 0; t < n_threads; t++) {
+        if (bands[t].terrain && read_costs(m, text, bands[t].first_row,
+                                           bands[t].last_row)) {
             maze_cleanup(m);
-            free(buf);
             return NULL;
         }
+    }
+    return m;
+}
+
+struct maze *maze_read(void) {
+    return maze_read_flags(MAZE_BYTES);
+}
+
+struct maze *maze_read_flags(int flags) {
+    // The number of rows is only known at the end, so read all of stdin
+    size_t capacity = 1 << 16;
+    size_t len = 0;
+    char *text = malloc(capacity);
+    while (text) {
+        len += fread(text + len, 1, capacity - len, stdin);
+        if (len < capacity) {
+            break;
+        }
+        char *bigger = realloc(text, 2 * capacity);
+        if (!bigger) {
+            free(text);
+            return NULL;
+        }
+        text = bigger;
+        capacity *= 2;
+    }
+    if (!text) {
+        return NULL;
+    }
+
+    struct maze *m = parse_text(text, len, flags);
+    free(text);
+    return m;
+}
+
+struct maze *maze_read_file(const char *path, int flags) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t) st.st_size;
+    const char *text = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED) {
+        return NULL;
+    }
+    if (len >= sizeof(MAZE_BIN_MAGIC)
+        && memcmp(text, MAZE_BIN_MAGIC, sizeof(MAZE_BIN_MAGIC)) == 0) {
+        munmap((void *) text, len);
+        return maze_load_bin(path, flags);
+    }
+    posix_madvise((void *) text, len, POSIX_MADV_SEQUENTIAL);
 
-        int column = 0;
-        while (buf[column] != '\n') {
-            check_for_start_and_dest(m, row, column, buf[column]);
-            set_value(m, row, column, buf[column]);
-            column++;
+    struct maze *m = parse_text(text, len, flags);
+    munmap((void *) text, len);
+    return m;
+}
+
+void maze_wall_row(const struct maze *m, int r, uint64_t *out) {
+    assert(r >= 0 && r < m->rows);
+    size_t row_words = ((size_t) m->cols + 63) / 64;
+    if (!m->data) {
+        // For a MAZE_PACKED maze this is a copy of the row.
+        memcpy(out, m->walls + (size_t) r * row_words,
+               row_words * sizeof(uint64_t));
+        return;
+    }
+    if (m->layout != MAZE_BYTES) {
+        memset(out, 0xff, row_words * sizeof(uint64_t));
+        for (int c = 0; c < m->cols; c++) {
+            if (m->data[maze_index64(m, r, c)] != WALL) {
+                out[c / 64] &= ~(UINT64_C(1) << (c % 64));
+            }
+        }
+        return;
+    }
+    pack_row(m->data + (size_t) r * (size_t) m->cols, m->cols, out,
+             row_words);
+}
+
+/* Returns the root of index 'i' in the union-find forest 'parent' and halves
+ * the path to it on the way. */
+static uint32_t find_root(uint32_t *parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/* Joins the sets of indices 'a' and 'b', the smaller root becomes the root
+ * of both. */
+static void unite(uint32_t *parent, uint32_t a, uint32_t b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+/* Returns true if bit 'c' is set in the row bitmap 'row'. */
+static bool row_wall(const uint64_t *row, int c) {
+    return (row[c / 64] >> (c % 64)) & 1;
+}
+
+int maze_label_components(struct maze *m) {
+    // Labels are indices, every index and NO_COMPONENT must fit
+    if (m->cells >= NO_COMPONENT) {
+        return 1;
+    }
+    size_t row_words = ((size_t) m->cols + 63) / 64;
+    uint32_t *labels = malloc(m->cells * sizeof(uint32_t));
+    uint64_t *above = malloc(row_words * sizeof(uint64_t));
+    uint64_t *row = malloc(row_words * sizeof(uint64_t));
+    if (!labels || !above || !row) {
+        free(labels);
+        free(above);
+        free(row);
+        return 1;
+    }
+    memset(labels, 0xff, m->cells * sizeof(uint32_t));
+
+    /* One scan joins every cell with the cells to its left and above, with
+     * the labels array as the union-find forest. The border row above the
+     * first row is all walls. */
+    memset(above, 0xff, row_words * sizeof(uint64_t));
+    for (int r = 1; r < m->rows - 1; r++) {
+        maze_wall_row(m, r, row);
+        for (int c = 1; c < m->cols - 1; c++) {
+            if (row_wall(row, c)) {
+                continue;
+            }
+            uint32_t i = (uint32_t) maze_index64(m, r, c);
+            labels[i] = i;
+            if (c > 1 && !row_wall(row, c - 1)) {
+                unite(labels, i, (uint32_t) maze_index64(m, r, c - 1));
+            }
+            if (!row_wall(above, c)) {
+                unite(labels, i, (uint32_t) maze_index64(m, r - 1, c));
+            }
+        }
+        uint64_t *tmp = above;
+        above = row;
+        row = tmp;
+    }
+    free(above);
+    free(row);
+
+    // Point every cell straight at its root, which is the component label
+    for (size_t i = 0; i < m->cells; i++) {
+        if (labels[i] != NO_COMPONENT) {
+            labels[i] = find_root(labels, (uint32_t) i);
+        }
+    }
+
+    free(m->labels);
+    m->labels = labels;
+    return 0;
+}
+
+bool maze_reachable(const struct maze *m, int r1, int c1, int r2, int c2) {
+    if (!m->labels) {
+        return true;
+    }
+    if (!maze_valid_move(m, r1, c1) || !maze_valid_move(m, r2, c2)) {
+        return false;
+    }
+    uint32_t label = m->labels[maze_index64(m, r1, c1)];
+    return label != NO_COMPONENT
+           && label == m->labels[maze_index64(m, r2, c2)];
+}
+
+/* Returns the cost stored for 'index' in 'costs', see maze_costs(). */
+static int cost_get(const uint8_t *costs, int64_t index) {
+    return ((costs[index / 2] >> (4 * (index % 2))) & 0xf) + 1;
+}
+
+int maze_cost(const struct maze *m, int r, int c) {
+    assert(r >= 0 && r < m->rows && c >= 0 && c < m->cols);
+    return m->costs ? cost_get(m->costs, maze_index64(m, r, c)) : 1;
+}
+
+int maze_set_cost(struct maze *m, int r, int c, int cost) {
+    assert(r >= 0 && r < m->rows && c >= 0 && c < m->cols);
+    if (cost < 1 || cost > MAX_COST) {
+        return 1;
+    }
+    if (!m->costs) {
+        if (cost == 1) {
+            return 0;
+        }
+        m->costs = calloc((m->cells + 1) / 2, 1);
+        if (!m->costs) {
+            return 1;
         }
-        row++;
-    } while (getline(&buf, &bufsize, stdin) == ncols + 1); // ncols + \n
+    }
+    int64_t index = maze_index64(m, r, c);
+    int shift = (int) (4 * (index % 2));
+    m->costs[index / 2] = (uint8_t) ((m->costs[index / 2] & ~(0xf << shift))
+                                     | (cost - 1) << shift);
+    return 0;
+}
+
+const uint8_t *maze_costs(const struct maze *m) {
+    return m->costs;
+}
+
+/* Returns the number of columns of the maze in the binary file with
+ * 'header'. */
+static uint64_t bin_cols(const struct maze_bin_header *header) {
+    return header->version == 1 ? header->rows : header->cols;
+}
+
+/* Returns true if 'header' is the header of a valid binary maze file of
+ * 'len' bytes. */
+static bool bin_header_valid(const struct maze_bin_header *header,
+                             size_t len) {
+    uint64_t rows = header->rows;
+    uint64_t cols = bin_cols(header);
+    return memcmp(header->magic, MAZE_BIN_MAGIC, sizeof(MAZE_BIN_MAGIC)) == 0
+           && (header->version == 1 || header->version == MAZE_BIN_VERSION)
+           && header->byte_order == MAZE_BIN_BYTE_ORDER
+           && rows > 0 && rows <= INT32_MAX
+           && cols > 0 && cols <= INT32_MAX
+           && header->row_words == (cols + 63) / 64
+           && header->start_index < rows * cols
+           && header->finish_index < rows * cols
+           && (len - sizeof(*header)) / sizeof(uint64_t) / rows
+              >= header->row_words;
+}
+
+int maze_save_bin(const struct maze *m, const char *filename) {
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open file %s\n", filename);
+        return 1;
+    }
+
+    // Indices in the file are always row-major
+    uint64_t cols = (uint64_t) m->cols;
+    uint64_t start = (uint64_t) maze_row64(m, m->start_index) * cols
+                     + (uint64_t) maze_col64(m, m->start_index);
+    uint64_t finish = (uint64_t) maze_row64(m, m->finish_index) * cols
+                      + (uint64_t) maze_col64(m, m->finish_index);
+
+    size_t row_words = ((size_t) m->cols + 63) / 64;
+    struct maze_bin_header header = {
+        .magic = MAZE_BIN_MAGIC,
+        .version = MAZE_BIN_VERSION,
+        .byte_order = MAZE_BIN_BYTE_ORDER,
+        .rows = (uint64_t) m->rows,
+        .row_words = row_words,
+        .start_index = start,
+        .finish_index = finish,
+        .cols = cols,
+    };
+    uint64_t *row = malloc(row_words * sizeof(uint64_t));
+    int err = !row || fwrite(&header, sizeof(header), 1, fp) != 1;
+    for (int r = 0; r < m->rows && !err; r++) {
+        maze_wall_row(m, r, row);
+        err = fwrite(row, sizeof(uint64_t), row_words, fp) != row_words;
+    }
+    free(row);
+    if (fclose(fp) != 0) {
+        err = 1;
+    }
+    return err;
+}
+
+struct maze *maze_load_bin(const char *filename, int flags) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0
+        || (size_t) st.st_size < sizeof(struct maze_bin_header)) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t) st.st_size;
+    // A private writable mapping, so maze_set() on a wall copies the page
+    // instead of changing the file.
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct maze_bin_header *header = map;
+    uint64_t rows = header->rows;
+    uint64_t cols = bin_cols(header);
+    struct maze *m = NULL;
+    if (bin_header_valid(header, len)) {
+        m = maze_create((int) rows, (int) cols, flags, false);
+    }
+    if (!m) {
+        munmap(map, len);
+        return NULL;
+    }
+    m->start_index = maze_index64(m, (int) (header->start_index / cols),
+                                  (int) (header->start_index % cols));
+    m->finish_index = maze_index64(m, (int) (header->finish_index / cols),
+                                   (int) (header->finish_index % cols));
 
-    if (row < ncols) { /* Error: more columns than rows */
-        maze_cleanup(m);
-        m = NULL;
+    uint64_t *payload = (uint64_t *) ((char *) map + sizeof(*header));
+    if (!m->data) {
+        // The payload is the walls bitmap, use it in place.
+        m->walls = payload;
+        m->map = map;
+        m->map_len = len;
+        return m;
     }
 
-    free(buf);
+    for (int r = 0; r < m->rows; r++) {
+        const uint64_t *row = payload + (size_t) r * header->row_words;
+        for (int c = 0; c < m->cols; c++) {
+            m->data[maze_index64(m, r, c)] =
+                (row[c / 64] >> (c % 64)) & 1 ? WALL : FLOOR;
+        }
+    }
+    munmap(map, len);
     return m;
 }
 
+int maze_bin_info(const char *filename, struct maze_bin_info *info) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    struct maze_bin_header header;
+    struct stat st;
+    bool valid = fstat(fd, &st) == 0
+                 && (size_t) st.st_size >= sizeof(header)
+                 && pread(fd, &header, sizeof(header), 0)
+                    == (ssize_t) sizeof(header)
+                 && bin_header_valid(&header, (size_t) st.st_size);
+    close(fd);
+    if (!valid) {
+        return 1;
+    }
+
+    info->rows = (int) header.rows;
+    info->cols = (int) bin_cols(&header);
+    info->start_index = (int64_t) header.start_index;
+    info->finish_index = (int64_t) header.finish_index;
+    info->row_words = (size_t) header.row_words;
+    info->offset = sizeof(header);
+    return 0;
+}
+
 void maze_start(const struct maze *m, int *r, int *c) {
-    *r = maze_row(m, m->start_index);
-    *c = maze_col(m, m->start_index);
+    *r = maze_row64(m, m->start_index);
+    *c = maze_col64(m, m->start_index);
 }
 
 void maze_destination(const struct maze *m, int *r, int *c) {
-    *r = maze_row(m, m->finish_index);
-    *c = maze_col(m, m->finish_index);
+    *r = maze_row64(m, m->finish_index);
+    *c = maze_col64(m, m->finish_index);
+}
+
+void maze_set_start(struct maze *m, int r, int c) {
+    m->start_index = maze_index64(m, r, c);
+}
+
+void maze_set_destination(struct maze *m, int r, int c) {
+    m->finish_index = maze_index64(m, r, c);
 }
 
 bool maze_at_start(const struct maze *m, int r, int c) {
-    return maze_index(m, r, c) == m->start_index;
+    return maze_index64(m, r, c) == m->start_index;
 }
 
 bool maze_at_destination(const struct maze *m, int r, int c) {
-    return maze_index(m, r, c) == m->finish_index;
+    return maze_index64(m, r, c) == m->finish_index;
 }
 
 bool maze_valid_move(const struct maze *m, int r, int c) {
-    if (r > 0 && r < (m->n - 1) && c > 0 && c < (m->n - 1)) {
+    if (r > 0 && r < (m->rows - 1) && c > 0 && c < (m->cols - 1)) {
         return true;
     }
     return false;
 }
 
 int maze_size(const struct maze *m) {
-    return m->n;
+    return m->rows;
+}
+
+int maze_rows(const struct maze *m) {
+    return m->rows;
+}
+
+int maze_cols(const struct maze *m) {
+    return m->cols;
+}
+
+size_t maze_cells(const struct maze *m) {
+    return m->cells;
+}
+
+/* Returns true if every cell on the border of 'm' is a WALL, so the border
+ * is a sentinel for maze_data() and maze_tile_data(). */
+static bool border_is_wall(const struct maze *m) {
+    for (int c = 0; c < m->cols; c++) {
+        if (m->data[maze_index64(m, 0, c)] != WALL
+            || m->data[maze_index64(m, m->rows - 1, c)] != WALL) {
+            return false;
+        }
+    }
+    for (int r = 0; r < m->rows; r++) {
+        if (m->data[maze_index64(m, r, 0)] != WALL
+            || m->data[maze_index64(m, r, m->cols - 1)] != WALL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+char *maze_data(struct maze *m) {
+    if (!m->data || m->layout != MAZE_BYTES || m->stamps
+        || !border_is_wall(m)) {
+        return NULL;
+    }
+    return m->data;
+}
+
+char *maze_tile_data(struct maze *m, struct maze_tile_steps *steps) {
+    if (!m->data || m->layout == MAZE_BYTES || m->stamps
+        || !border_is_wall(m)) {
+        return NULL;
+    }
+
+    // The bits of the column and of the row within a tile, see maze_index()
+    int64_t col_bits = TILE_MASK;
+    int64_t row_bits = TILE_MASK << TILE_BITS;
+    if (m->layout == MAZE_MORTON) {
+        col_bits = spread_bits(TILE_MASK);
+        row_bits = col_bits << 1;
+    }
+    int64_t tile_size = INT64_C(1) << (2 * TILE_BITS);
+    int64_t tile_row = (int64_t) m->tile_cols * tile_size;
+
+    for (int move = 0; move < N_MOVES; move++) {
+        bool vertical = m_offsets[move][0] != 0;
+        int step = m_offsets[move][0] + m_offsets[move][1];
+        int64_t field = vertical ? row_bits : col_bits;
+        steps->field[move] = field;
+        steps->fill[move] = step > 0 ? (tile_size - 1) & ~field : 0;
+        steps->step[move] = step;
+        steps->edge[move] = step > 0 ? field : 0;
+        steps->tile[move] = step * (vertical ? tile_row : tile_size);
+    }
+    return m->data;
+}
+
+void maze_index_deltas(const struct maze *m, int deltas[N_MOVES]) {
+    for (int move = 0; move < N_MOVES; move++) {
+        deltas[move] = m_offsets[move][0] * m->cols + m_offsets[move][1];
+    }
+}
+
+/* In the tiled layouts an index is the tile number, row-major over the
+ * tiles, followed by TILE_BITS * 2 bits for the cell within the tile: row
+ * then column for MAZE_TILED, the bits of both interleaved (Z-order) for
+ * MAZE_MORTON.
+ *
+ * The int versions below are the same computations, they are kept apart so
+ * solvers of mazes that fit in an int do not pay for 64-bit division. */
+int64_t maze_index64(const struct maze *m, int r, int c) {
+    if (m->layout == MAZE_BYTES) {
+        return (int64_t) m->cols * r + c;
+    }
+    int64_t tile = (int64_t) (r >> TILE_BITS) * m->tile_cols
+                   + (c >> TILE_BITS);
+    int within;
+    if (m->layout == MAZE_TILED) {
+        within = (r & TILE_MASK) << TILE_BITS | (c & TILE_MASK);
+    } else {
+        within = (int) (spread_bits((unsigned) r & TILE_MASK) << 1
+                        | spread_bits((unsigned) c & TILE_MASK));
+    }
+    return tile << (2 * TILE_BITS) | within;
+}
+
+int maze_row64(const struct maze *m, int64_t index) {
+    if (m->layout == MAZE_BYTES) {
+        return (int) (index / m->cols);
+    }
+    int64_t tile = index >> (2 * TILE_BITS);
+    int within = (int) (index & ((1 << (2 * TILE_BITS)) - 1));
+    int r = (int) (tile / m->tile_cols) << TILE_BITS;
+    if (m->layout == MAZE_TILED) {
+        return r | within >> TILE_BITS;
+    }
+    return r | (int) gather_bits((unsigned) within >> 1);
+}
+
+int maze_col64(const struct maze *m, int64_t index) {
+    if (m->layout == MAZE_BYTES) {
+        return (int) (index % m->cols);
+    }
+    int64_t tile = index >> (2 * TILE_BITS);
+    int within = (int) (index & ((1 << (2 * TILE_BITS)) - 1));
+    int c = (int) (tile % m->tile_cols) << TILE_BITS;
+    if (m->layout == MAZE_TILED) {
+        return c | (within & TILE_MASK);
+    }
+    return c | (int) gather_bits((unsigned) within);
 }
 
 int maze_index(const struct maze *m, int r, int c) {
-    return m->n * r + c;
+    if (m->layout == MAZE_BYTES) {
+        return m->cols * r + c;
+    }
+    int tile = (r >> TILE_BITS) * m->tile_cols + (c >> TILE_BITS);
+    int within;
+    if (m->layout == MAZE_TILED) {
+        within = (r & TILE_MASK) << TILE_BITS | (c & TILE_MASK);
+    } else {
+        within = (int) (spread_bits((unsigned) r & TILE_MASK) << 1
+                        | spread_bits((unsigned) c & TILE_MASK));
+    }
+    return tile << (2 * TILE_BITS) | within;
 }
 
 int maze_row(const struct maze *m, int index) {
-    return index / m->n;
+    if (m->layout == MAZE_BYTES) {
+        return index / m->cols;
+    }
+    int tile = index >> (2 * TILE_BITS);
+    int within = index & ((1 << (2 * TILE_BITS)) - 1);
+    int r = (tile / m->tile_cols) << TILE_BITS;
+    if (m->layout == MAZE_TILED) {
+        return r | within >> TILE_BITS;
+    }
+    return r | (int) gather_bits((unsigned) within >> 1);
 }
 
 int maze_col(const struct maze *m, int index) {
-    return index % m->n;
+    if (m->layout == MAZE_BYTES) {
+        return index % m->cols;
+    }
+    int tile = index >> (2 * TILE_BITS);
+    int within = index & ((1 << (2 * TILE_BITS)) - 1);
+    int c = (tile % m->tile_cols) << TILE_BITS;
+    if (m->layout == MAZE_TILED) {
+        return c | (within & TILE_MASK);
+    }
+    return c | (int) gather_bits((unsigned) within);
 }
@@ -1,8 +1,8 @@
-/* Do not edit this file. */
-
 #ifndef _MAZE_H_
 #define _MAZE_H_
 
+#include <stdint.h>
+
 /* Defines for ascii characters used in the maze array. */
 #define WALL '#'
 #define FLOOR ' '
@@ -17,14 +17,100 @@
 #define N_MOVES 4
 extern int m_offsets[N_MOVES][2];
 
+/* Storage flags for creating a maze.
+ * MAZE_BYTES stores one character per cell.
+ * MAZE_PACKED stores the walls in a bitmap with one bit per cell and keeps the
+ * solver state (VISITED and PATH) in two separate bitmaps. maze_get() and
+ * maze_set() still work on characters, but only WALL, FLOOR, VISITED and PATH
+ * can be stored (TO_VISIT is stored as VISITED). */
+#define MAZE_BYTES 0x0
+#define MAZE_PACKED 0x1
+
+/* Layout flags for a MAZE_BYTES maze, ignored for MAZE_PACKED.
+ * By default cells are stored row by row. MAZE_TILED stores the maze in
+ * square tiles that are stored row by row themselves, so cells above and
+ * below are in the same page and often in the same cache line. MAZE_MORTON
+ * orders the cells within a tile along a Z-order curve, so neighbours in
+ * both directions are close. The layout only changes what maze_index()
+ * returns, the maze interface works the same. A solver reads the raw cells
+ * of these layouts through maze_tile_data() instead of maze_data(). */
+#define MAZE_TILED 0x2
+#define MAZE_MORTON 0x4
+
+/* State flag for answering many queries on one maze. MAZE_EPOCH keeps the
+ * solver state (VISITED and PATH) apart from the walls, stamped with an epoch
+ * counter, so maze_reset() only has to bump the counter. It can be combined
+ * with any of the flags above. */
+#define MAZE_EPOCH 0x8
+
+/* Highest cost of moving onto a cell, see maze_cost(). */
+#define MAX_COST 9
+
 /* Forward declaration for using a struct maze pointer in the prototypes. */
 struct maze;
 
-/* Reads a square maze from stdin. Start and destination markers are detected
- * and recorded. Everything that is not a WALL is stored as a FLOOR.
+/* Reads a maze from stdin. The first line sets the number of columns and
+ * every row up to the end of the input or an empty line must have that many
+ * columns, so the maze can be rectangular. Start and destination markers are
+ * detected and recorded. Everything that is not a WALL is stored as a
+ * FLOOR, a digit from 2 to MAX_COST sets the cost of its cell as well (see
+ * maze_cost()).
  * Returns a pointer to the maze or NULL if an error occured. */
 struct maze *maze_read(void);
 
+/* Same as maze_read(), but the maze is stored as selected by 'flags'. */
+struct maze *maze_read_flags(int flags);
+
+/* Reads a maze from the file 'path' with the same rules as
+ * maze_read(). The file is memory mapped and its rows are translated in
+ * parallel, which is much faster than maze_read() for large mazes.
+ * Binary maze files (see maze_save_bin()) are recognised and loaded with
+ * maze_load_bin().
+ * Returns a pointer to the maze or NULL if an error occured. */
+struct maze *maze_read_file(const char *path, int flags);
+
+/* Writes maze 'm' to 'filename' in the binary maze format: a header with the
+ * size and the start and destination indices, followed by the walls as a
+ * bitmap with one bit per cell. Solver state and costs are not saved.
+ * Returns 0 if successful, 1 otherwise. */
+int maze_save_bin(const struct maze *m, const char *filename);
+
+/* Reads a maze written by maze_save_bin(). The file is memory mapped and a
+ * MAZE_PACKED maze uses the bitmap in the mapping directly, so loading does
+ * not touch the cells at all.
+ * Returns a pointer to the maze or NULL if an error occured. */
+struct maze *maze_load_bin(const char *filename, int flags);
+
+/* Where the parts of a binary maze file are, see maze_bin_info(). The
+ * walls of row r are 'row_words' 64-bit words at byte 'offset' +
+ * r * row_words * 8 of the file, laid out as for maze_wall_row(). The start
+ * and destination are row-major indices, row * cols + column. */
+struct maze_bin_info {
+    int rows;
+    int cols;
+    int64_t start_index;
+    int64_t finish_index;
+    size_t row_words;
+    size_t offset;
+};
+
+/* Reads only the header of the binary maze file 'filename' into 'info', for
+ * programs that read the walls themselves because the maze does not fit in
+ * memory.
+ * Returns 0 if successful, 1 otherwise. */
+int maze_bin_info(const char *filename, struct maze_bin_info *info);
+
+/* Creates a square maze of 'n' rows by 'n' columns filled with walls, stored
+ * as selected by 'flags'. The start is at (1, 1) and the destination at
+ * (n - 2, n - 2). This is how maze_read() starts, and how a maze can be
+ * built without reading one.
+ * Returns a pointer to the maze or NULL if an error occured. */
+struct maze *maze_init(int n, int flags);
+
+/* Same as maze_init() for a maze of 'rows' rows by 'cols' columns. The
+ * destination is at (rows - 2, cols - 2). */
+struct maze *maze_init_rect(int rows, int cols, int flags);
+
 /* Frees all memory associated with the maze. */
 void maze_cleanup(struct maze *m);
 
@@ -34,6 +120,11 @@ char maze_get(const struct maze *m, int r, int c);
 /* Sets the maze character at row 'r', column 'c' to 'value'. */
 void maze_set(struct maze *m, int r, int c, char value);
 
+/* Turns every VISITED, TO_VISIT and PATH cell back into a FLOOR, so the maze
+ * can be solved again. This takes constant time for a MAZE_EPOCH maze and
+ * touches every cell otherwise. */
+void maze_reset(struct maze *m);
+
 /* Prints the maze to stdout. If 'blocks' is true walls are printed as a block
  * character, otherwise the WALL character '#' is used. */
 void maze_print(const struct maze *m, bool blocks);
@@ -41,6 +132,16 @@ void maze_print(const struct maze *m, bool blocks);
 /* Writes the maze in Portable Pixmap (ppm) format to 'filename'. */
 int maze_output_ppm(const struct maze *m, const char *filename);
 
+/* Writes the maze as a ppm image to 'filename' whose longer side is 'size'
+ * pixels, the other side keeps the aspect ratio of the maze.
+ * Every pixel covers a block of cells and shows the start, destination or
+ * path if the block holds one, otherwise the average gray of its walls and
+ * corridors. Mazes no larger than 'size' are written as by
+ * maze_output_ppm().
+ * Returns 0 if successful, 1 otherwise. */
+int maze_output_thumbnail(const struct maze *m, const char *filename,
+                          int size);
+
 /* Sets the integer values pointed to by 'r' and 'c' to the row
  * and column of the start position. */
 void maze_start(const struct maze *m, int *r, int *c);
@@ -49,6 +150,44 @@ void maze_start(const struct maze *m, int *r, int *c);
  * and column of the destination position. */
 void maze_destination(const struct maze *m, int *r, int *c);
 
+/* Stores the walls of row 'r' as a bitmap in 'out': bit c % 64 of word c / 64
+ * is set if column 'c' is a WALL. 'out' must hold (maze_cols(m) + 63) / 64
+ * words, the bits after the last column are set as well. */
+void maze_wall_row(const struct maze *m, int r, uint64_t *out);
+
+/* Moves the start location to row 'r', column 'c'. */
+void maze_set_start(struct maze *m, int r, int c);
+
+/* Moves the destination location to row 'r', column 'c'. */
+void maze_set_destination(struct maze *m, int r, int c);
+
+/* Labels the connected components of the FLOOR cells, so maze_reachable()
+ * answers in constant time. The labels stay valid until a WALL is added or
+ * removed with maze_set(). Labels are 32-bit, a maze with UINT32_MAX cells
+ * or more can not be labeled.
+ * Returns 0 if successful, 1 otherwise. */
+int maze_label_components(struct maze *m);
+
+/* Returns false if there is no path from (r1, c1) to (r2, c2) because they
+ * are in different components or one of them is a WALL. Without labels from
+ * maze_label_components() it cannot tell and always returns true. */
+bool maze_reachable(const struct maze *m, int r1, int c1, int r2, int c2);
+
+/* Returns the cost of moving onto the cell at row 'r', column 'c', from 1
+ * to MAX_COST. Every cell costs 1 unless maze_read() found a digit for it
+ * or it was set with maze_set_cost(). */
+int maze_cost(const struct maze *m, int r, int c);
+
+/* Sets the cost of moving onto the cell at row 'r', column 'c' to 'cost'.
+ * Returns 0 if successful, 1 if 'cost' is out of range or the costs could
+ * not be allocated. */
+int maze_set_cost(struct maze *m, int r, int c, int cost);
+
+/* Returns the costs of maze 'm' for a solver's inner loop, or NULL if every
+ * cell costs 1. The cost of index i minus one is stored in 4 bits of byte
+ * i / 2, the low bits for an even i and the high bits for an odd one. */
+const uint8_t *maze_costs(const struct maze *m);
+
 /* Returns true if (r, c) is the start location. */
 bool maze_at_start(const struct maze *m, int r, int c);
 
@@ -56,28 +195,97 @@ bool maze_at_start(const struct maze *m, int r, int c);
 bool maze_at_destination(const struct maze *m, int r, int c);
 
 /* Returns true if (r, c) is valid position in the maze.
- * Note: The borders of the maze, rows 0 and maze_size() - 1 and columns
- * 0 and maze_size() - 1, are inaccessible. */
+ * Note: The borders of the maze, rows 0 and maze_rows() - 1 and columns
+ * 0 and maze_cols() - 1, are inaccessible. */
 bool maze_valid_move(const struct maze *m, int r, int c);
 
-/* Returns the size of the maze 'm'.
- *
- * We only support square mazes, so the size is the number of rows
- * which is also the number of columns. */
+/* Returns the size of the square maze 'm', the number of rows which is also
+ * the number of columns. Code that handles rectangular mazes uses
+ * maze_rows() and maze_cols(). */
 int maze_size(const struct maze *m);
 
+/* Returns the number of rows of the maze 'm'. */
+int maze_rows(const struct maze *m);
+
+/* Returns the number of columns of the maze 'm'. */
+int maze_cols(const struct maze *m);
+
+/* Returns the number of indices of the maze: every index returned by
+ * maze_index() is less than this. It is maze_rows(m) * maze_cols(m) for the
+ * default layout, the tiled layouts add padding cells. */
+size_t maze_cells(const struct maze *m);
+
 /* Returns the index in the 1d array for row 'r' and column 'c'.
  *
  * Although there is no need to expose that the maze is internally stored
  * as one dimension array, using the index allows a location to be
  * stored as a single integer on the stack or queue instead of two
- * separate integers for the row and column of a location. */
+ * separate integers for the row and column of a location.
+ *
+ * maze_index(), maze_row() and maze_col() use an int index and are only
+ * valid if maze_cells(m) <= INT_MAX. Larger mazes use maze_index64(),
+ * maze_row64() and maze_col64(). */
 int maze_index(const struct maze *m, int r, int c);
 
+/* Returns the cells of maze 'm' as one character per index, so a solver can
+ * read and mark them in its inner loop without maze_get() and maze_set().
+ * This is only possible for a MAZE_BYTES maze in the default layout without
+ * MAZE_EPOCH whose border is all WALL, otherwise NULL is returned.
+ * The border is then a sentinel: a neighbour of a cell inside the border is
+ * always a valid index and never a FLOOR if it is on the border, so moving
+ * from an index needs neither maze_row()/maze_col() nor bounds checks. */
+char *maze_data(struct maze *m);
+
+/* Stores in 'deltas' the change of the index for each of the N_MOVES moves
+ * of m_offsets, in the same order: -maze_cols(m), 1, maze_cols(m), -1 for
+ * the indices of maze_data(). */
+void maze_index_deltas(const struct maze *m, int deltas[N_MOVES]);
+
+/* How each of the N_MOVES moves changes an index of a tiled layout, see
+ * maze_tile_data(). A move adds 'step' (1 or -1) to the row or the column
+ * within the tile, which are the bits 'field' of the index. 'fill' sets the
+ * other bits of the tile so the carry of an increment runs through them.
+ * Leaving the tile over its 'edge' wraps the field around and adds 'tile'
+ * to the index, the distance to the neighbouring tile. */
+struct maze_tile_steps {
+    int64_t field[N_MOVES];
+    int64_t fill[N_MOVES];
+    int64_t step[N_MOVES];
+    int64_t edge[N_MOVES];
+    int64_t tile[N_MOVES];
+};
+
+/* Same as maze_data() for a MAZE_BYTES maze in the MAZE_TILED or MAZE_MORTON
+ * layout, with the same conditions otherwise: the cells in the order of
+ * maze_index(), and in 'steps' how to move between them with
+ * maze_tile_step(). Returns NULL for the default layout, use maze_data()
+ * there. */
+char *maze_tile_data(struct maze *m, struct maze_tile_steps *steps);
+
+/* Returns the index after 'move' from 'index' in a maze of
+ * maze_tile_data(), with its 'steps'. Like an index delta it needs neither
+ * maze_row()/maze_col() nor bounds checks, and it is inline so the inner
+ * loop of a solver stays a few instructions per neighbour. */
+static inline int64_t maze_tile_step(const struct maze_tile_steps *steps,
+                                     int64_t index, int move) {
+    int64_t field = steps->field[move];
+    int64_t bits = index & field;
+    int64_t moved = (index & ~field)
+                    | (((bits | steps->fill[move]) + steps->step[move])
+                       & field);
+    return bits == steps->edge[move] ? moved + steps->tile[move] : moved;
+}
+
 /* Returns the row number of the 1d 'index'. */
 int maze_row(const struct maze *m, int index);
 
 /* Returns the column number of the 1d 'index'. */
 int maze_col(const struct maze *m, int index);
 
+/* Same as maze_index(), maze_row() and maze_col() with 64-bit indices, for
+ * mazes of any size. */
+int64_t maze_index64(const struct maze *m, int r, int c);
+int maze_row64(const struct maze *m, int64_t index);
+int maze_col64(const struct maze *m, int64_t index);
+
 #endif
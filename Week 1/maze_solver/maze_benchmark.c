@@ -0,0 +1,503 @@
+// Needed for getopt(), mkdtemp() and realpath()
+#define _POSIX_C_SOURCE 200809L
+// Needed for wait4()
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Runs solvers over a sweep of generated mazes and reports one record per
+ * measured run as CSV or JSON on stdout.
+ *
+ *   maze_benchmark [-f csv|json] [-w warmup] [-n reps] [-g generator]
+ *                  [-a algorithm] [-l density] [-s seed]
+ *                  -x "solver [flags]" [-x ...] size...
+ *
+ * For every size one maze is generated with the generator (maze_generate by
+ * default) and every solver is run 'warmup' times without recording and then
+ * 'reps' times. Every run is a separate process started with -s and the maze
+ * file, so the peak RSS is the solver's own. A record has:
+ *
+ *   wall_s        wall time of the whole process, reading, preprocessing
+ *                 and printing too
+ *   setup_s       time of the preprocessing alone, e.g. the junction graph
+ *                 or the landmark tables, from the solver's 'setup' line
+ *   solve_s       time of the search alone, from the solver's 'time' line,
+ *                 so without the preprocessing
+ *   expanded      elements popped from the frontier, the 'stats' lines
+ *   cells_per_s   expanded / solve_s
+ *   peak_frontier largest number of elements in the frontier at once
+ *   peak_rss_kb   maximum resident set size of the solver process
+ *
+ * Values a solver does not print are empty in CSV and null in JSON. The runs
+ * happen in a temporary directory, so the out.ppm the solvers write does not
+ * end up in the working directory. The landmark tables alt saves next to the
+ * maze are removed before every run, so every run does its own
+ * preprocessing instead of loading that of an earlier one.
+ */
+
+#define MAX_SOLVERS 32
+#define MAX_ARGS 32
+#define LINE_SIZE 256
+
+/* Suffix of the landmark tables alt saves next to the maze file. */
+#define LANDMARKS_SUFFIX ".lmk"
+#define USAGE "usage: %s [-f csv|json] [-w warmup] [-n reps] [-g generator] " \
+              "[-a algorithm] [-l density] [-s seed] " \
+              "-x \"solver [flags]\" [-x ...] size...\n"
+
+/* A solver command line, split in words. */
+struct solver {
+    const char *spec;
+    char *words;
+    char *argv[MAX_ARGS + 3];
+    int argc;
+};
+
+/* The measurements of one run, negative if the solver did not report it. */
+struct result {
+    int path_length;
+    double wall;
+    double setup;
+    double solve;
+    long expanded;
+    long peak_frontier;
+    long peak_rss;
+};
+
+/* Directory the runs happen in, with the generated maze. */
+static char work_dir[] = "/tmp/maze_benchmark.XXXXXX";
+
+/* Returns the current time in seconds. */
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec / 1e9;
+}
+
+/* Makes 'path' absolute if it names a file relative to the working
+ * directory, the runs happen in 'work_dir'. Names without a slash are left
+ * to the PATH search of execvp().
+ * Returns the path, which is allocated if it was changed, or NULL if an
+ * error occured. */
+static char *resolve(const char *path) {
+    if (strchr(path, '/') == NULL) {
+        return strdup(path);
+    }
+    return realpath(path, NULL);
+}
+
+/* Splits the command line 'spec' in words into 's'.
+ * Returns 0 if successful, 1 otherwise. */
+static int solver_init(struct solver *s, const char *spec) {
+    s->spec = spec;
+    s->argc = 0;
+    s->words = strdup(spec);
+    if (s->words == NULL) {
+        return 1;
+    }
+
+    for (char *word = strtok(s->words, " \t"); word;
+         word = strtok(NULL, " \t")) {
+        if (s->argc == MAX_ARGS) {
+            fprintf(stderr, "Too many words in solver %s\n", spec);
+            s->argc = 0;
+            return 1;
+        }
+        s->argv[s->argc++] = word;
+    }
+    if (s->argc == 0) {
+        fprintf(stderr, "Empty solver command\n");
+        return 1;
+    }
+
+    s->argv[0] = resolve(s->argv[0]);
+    if (s->argv[0] == NULL) {
+        fprintf(stderr, "Cannot find solver %s\n", spec);
+        return 1;
+    }
+    return 0;
+}
+
+/* Starts 'argv' in 'work_dir' with its stdout going to 'out_fd' and its
+ * stderr to 'err_fd', closes both in the parent.
+ * Returns the process id or -1 if an error occured. */
+static pid_t start(char *const argv[], int out_fd, int err_fd) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(work_dir) || dup2(out_fd, STDOUT_FILENO) == -1
+            || (err_fd != -1 && dup2(err_fd, STDERR_FILENO) == -1)) {
+            _exit(127);
+        }
+        execvp(argv[0], argv);
+        fprintf(stderr, "Cannot run %s\n", argv[0]);
+        _exit(127);
+    }
+    close(out_fd);
+    if (err_fd != -1) {
+        close(err_fd);
+    }
+    return pid;
+}
+
+/* Generates the maze of the given size into 'maze_file' with 'argv', the
+ * generator command without the size.
+ * Returns 0 if successful, 1 otherwise. */
+static int generate(char *argv[], int argc, long size, const char *maze_file) {
+    char size_arg[32];
+    snprintf(size_arg, sizeof(size_arg), "%ld", size);
+    argv[argc] = size_arg;
+    argv[argc + 1] = NULL;
+
+    int fd = open(maze_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Cannot create %s\n", maze_file);
+        return 1;
+    }
+    pid_t pid = start(argv, fd, -1);
+    int status;
+    if (pid == -1 || waitpid(pid, &status, 0) == -1
+        || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Could not generate a maze of size %ld\n", size);
+        return 1;
+    }
+    return 0;
+}
+
+/* Reads the 'stats', 'setup' and 'time' lines the solver wrote to
+ * 'err_file' into 'r'. A solver can print several 'stats' lines, for several
+ * frontiers or searches: their pops are added up and the largest peak is
+ * kept. */
+static void parse_stats(const char *err_file, struct result *r) {
+    FILE *fp = fopen(err_file, "r");
+    if (!fp) {
+        return;
+    }
+
+    char line[LINE_SIZE];
+    long pushes, pops, peak;
+    double seconds;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "stats %ld %ld %ld", &pushes, &pops, &peak) == 3) {
+            r->expanded = (r->expanded < 0 ? 0 : r->expanded) + pops;
+            if (peak > r->peak_frontier) {
+                r->peak_frontier = peak;
+            }
+        } else if (sscanf(line, "time %lf", &seconds) == 1) {
+            r->solve = seconds;
+        } else if (sscanf(line, "setup %lf", &seconds) == 1) {
+            r->setup = seconds;
+        }
+    }
+    fclose(fp);
+}
+
+/* Runs solver 's' once on 'maze_file' and fills in 'r'.
+ * Returns 0 if successful, 1 otherwise. */
+static int run(struct solver *s, const char *maze_file, struct result *r) {
+    char err_file[PATH_MAX];
+    snprintf(err_file, sizeof(err_file), "%s/stderr", work_dir);
+
+    // Landmark tables saved by an earlier run would skip the preprocessing
+    char table_file[PATH_MAX];
+    snprintf(table_file, sizeof(table_file), "%s/maze.txt%s", work_dir,
+             LANDMARKS_SUFFIX);
+    unlink(table_file);
+
+    // -s goes first, so a solver that stops at the file name still sees it
+    char *argv[MAX_ARGS + 3];
+    argv[0] = s->argv[0];
+    argv[1] = "-s";
+    for (int i = 1; i < s->argc; i++) {
+        argv[i + 1] = s->argv[i];
+    }
+    argv[s->argc + 1] = (char *) maze_file;
+    argv[s->argc + 2] = NULL;
+
+    int out[2];
+    if (pipe(out)) {
+        return 1;
+    }
+    int err_fd = open(err_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (err_fd == -1) {
+        close(out[0]);
+        close(out[1]);
+        return 1;
+    }
+
+    *r = (struct result) {-1, -1, -1, -1, -1, -1, -1};
+    double t_start = now();
+    pid_t pid = start(argv, out[1], err_fd);
+    if (pid == -1) {
+        close(out[0]);
+        return 1;
+    }
+
+    // The path length comes first, the printed maze after it is thrown away
+    FILE *fp = fdopen(out[0], "r");
+    if (!fp) {
+        close(out[0]);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+    char line[LINE_SIZE];
+    bool first = true;
+    while (fgets(line, sizeof(line), fp)) {
+        char *found = first ? strstr(line, "path of length: ") : NULL;
+        if (found) {
+            r->path_length = atoi(found + strlen("path of length: "));
+        }
+        first = false;
+    }
+    fclose(fp);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == -1) {
+        return 1;
+    }
+    r->wall = now() - t_start;
+    r->peak_rss = usage.ru_maxrss;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return 1;
+    }
+
+    parse_stats(err_file, r);
+    return 0;
+}
+
+/* Prints 'value' as a field, or nothing (CSV) or null (JSON) if it is
+ * negative. */
+static void print_long(long value, bool json) {
+    if (value >= 0) {
+        printf("%ld", value);
+    } else if (json) {
+        printf("null");
+    }
+}
+
+/* Same as print_long() for a number of seconds or a rate. */
+static void print_double(double value, bool json) {
+    if (value >= 0) {
+        printf("%.6f", value);
+    } else if (json) {
+        printf("null");
+    }
+}
+
+/* Prints 'text' as a JSON string. */
+static void print_json_string(const char *text) {
+    putchar('"');
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            putchar('\\');
+        }
+        putchar(*text);
+    }
+    putchar('"');
+}
+
+/* Prints the record of one measured run. */
+static void print_result(const struct solver *s, long size, int rep,
+                         const struct result *r, bool json, bool first) {
+    double rate = r->expanded >= 0 && r->solve > 0
+                  ? (double) r->expanded / r->solve : -1;
+    if (json) {
+        printf("%s\n  {\"size\": %ld, \"solver\": ", first ? "" : ",", size);
+        print_json_string(s->spec);
+        printf(", \"rep\": %d, \"path_length\": ", rep);
+        print_long(r->path_length, true);
+        printf(", \"wall_s\": ");
+        print_double(r->wall, true);
+        printf(", \"setup_s\": ");
+        print_double(r->setup, true);
+        printf(", \"solve_s\": ");
+        print_double(r->solve, true);
+        printf(", \"expanded\": ");
+        print_long(r->expanded, true);
+        printf(", \"cells_per_s\": ");
+        print_double(rate, true);
+        printf(", \"peak_frontier\": ");
+        print_long(r->peak_frontier, true);
+        printf(", \"peak_rss_kb\": ");
+        print_long(r->peak_rss, true);
+        printf("}");
+    } else {
+        // The solver is quoted, its flags are separated by spaces
+        printf("%ld,\"%s\",%d,", size, s->spec, rep);
+        print_long(r->path_length, false);
+        putchar(',');
+        print_double(r->wall, false);
+        putchar(',');
+        print_double(r->setup, false);
+        putchar(',');
+        print_double(r->solve, false);
+        putchar(',');
+        print_long(r->expanded, false);
+        putchar(',');
+        print_double(rate, false);
+        putchar(',');
+        print_long(r->peak_frontier, false);
+        putchar(',');
+        print_long(r->peak_rss, false);
+        putchar('\n');
+    }
+    fflush(stdout);
+}
+
+/* Runs every solver on every size and prints the records.
+ * Returns 0 if successful, 1 if a maze or a run failed. */
+static int benchmark(struct solver *solvers, int n_solvers,
+                     char *gen_argv[], int gen_argc, char *sizes[],
+                     int n_sizes, int warmup, int reps, bool json) {
+    char maze_file[PATH_MAX];
+    snprintf(maze_file, sizeof(maze_file), "%s/maze.txt", work_dir);
+
+    int status = 0;
+    bool first = true;
+    if (json) {
+        printf("[");
+    } else {
+        printf("size,solver,rep,path_length,wall_s,setup_s,solve_s,"
+               "expanded,cells_per_s,peak_frontier,peak_rss_kb\n");
+    }
+
+    for (int i = 0; i < n_sizes; i++) {
+        long size = atol(sizes[i]);
+        if (generate(gen_argv, gen_argc, size, maze_file)) {
+            status = 1;
+            continue;
+        }
+
+        for (int j = 0; j < n_solvers; j++) {
+            for (int rep = -warmup; rep < reps; rep++) {
+                struct result r;
+                if (run(&solvers[j], maze_file, &r)) {
+                    fprintf(stderr, "%s failed on size %ld\n",
+                            solvers[j].spec, size);
+                    status = 1;
+                    break;
+                }
+                if (rep >= 0) {
+                    print_result(&solvers[j], size, rep, &r, json, first);
+                    first = false;
+                }
+            }
+        }
+    }
+
+    if (json) {
+        printf("\n]\n");
+    }
+    return status;
+}
+
+/* Removes the files the runs left in 'work_dir' and the directory itself. */
+static void remove_work_dir(void) {
+    const char *files[] = {"maze.txt", "maze.txt" LANDMARKS_SUFFIX, "stderr",
+                           "out.ppm"};
+    char path[PATH_MAX];
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", work_dir, files[i]);
+        unlink(path);
+    }
+    rmdir(work_dir);
+}
+
+int main(int argc, char *argv[]) {
+    /* -f selects the output format: csv (default) or json,
+     * -w sets the number of warmup runs that are not recorded,
+     * -n sets the number of recorded runs,
+     * -g sets the generator, -a, -l and -s are passed on to it,
+     * -x adds a solver with its flags, in one argument */
+    bool json = false;
+    int warmup = 1;
+    int reps = 3;
+    const char *generator = "./maze_generate";
+    char *gen_options[6];
+    int n_gen_options = 0;
+    struct solver solvers[MAX_SOLVERS];
+    const char *specs[MAX_SOLVERS];
+    int n_solvers = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:w:n:g:a:l:s:x:")) != -1) {
+        switch (opt) {
+        case 'f':
+            json = strcmp(optarg, "json") == 0;
+            break;
+        case 'w':
+            warmup = atoi(optarg);
+            break;
+        case 'n':
+            reps = atoi(optarg);
+            break;
+        case 'g':
+            generator = optarg;
+            break;
+        case 'a':
+        case 'l':
+        case 's':
+            if (n_gen_options < 6) {
+                gen_options[n_gen_options++] = opt == 'a' ? "-a"
+                                               : opt == 'l' ? "-l" : "-s";
+                gen_options[n_gen_options++] = optarg;
+            }
+            break;
+        case 'x':
+            if (n_solvers == MAX_SOLVERS) {
+                fprintf(stderr, "At most %d solvers\n", MAX_SOLVERS);
+                return 1;
+            }
+            specs[n_solvers++] = optarg;
+            break;
+        default:
+            fprintf(stderr, USAGE, argv[0]);
+            return 1;
+        }
+    }
+    if (n_solvers == 0 || optind == argc || warmup < 0 || reps < 1) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    char *gen_argv[8 + 2];
+    gen_argv[0] = resolve(generator);
+    if (gen_argv[0] == NULL) {
+        fprintf(stderr, "Cannot find generator %s\n", generator);
+        return 1;
+    }
+    for (int i = 0; i < n_gen_options; i++) {
+        gen_argv[i + 1] = gen_options[i];
+    }
+
+    int status = 0;
+    int n_ready = 0;
+    for (; n_ready < n_solvers && status == 0; n_ready++) {
+        status = solver_init(&solvers[n_ready], specs[n_ready]);
+    }
+    if (status == 0 && mkdtemp(work_dir) == NULL) {
+        fprintf(stderr, "Cannot create a temporary directory\n");
+        status = 1;
+    } else if (status == 0) {
+        status = benchmark(solvers, n_solvers, gen_argv, n_gen_options + 1,
+                           argv + optind, argc - optind, warmup, reps, json);
+        remove_work_dir();
+    }
+
+    for (int i = 0; i < n_ready; i++) {
+        free(solvers[i].words);
+        if (solvers[i].argc > 0) {
+            free(solvers[i].argv[0]);
+        }
+    }
+    free(gen_argv[0]);
+    return status;
+}
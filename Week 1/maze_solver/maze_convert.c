@@ -0,0 +1,62 @@
+// Needed for getopt()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "maze.h"
+
+/* Converts between the text and the binary maze format.
+ *
+ *   maze_convert in.txt out.bin    text to binary ('-' reads stdin)
+ *   maze_convert -t in.bin         binary to text on stdout
+ */
+int main(int argc, char *argv[]) {
+    bool to_text = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "t")) != -1) {
+        switch (opt) {
+        case 't':
+            to_text = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s in.txt out.bin | %s -t in.bin\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (argc - optind != (to_text ? 1 : 2)) {
+        fprintf(stderr, "usage: %s in.txt out.bin | %s -t in.bin\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+
+    const char *in = argv[optind];
+    struct maze *m;
+    if (to_text) {
+        m = maze_load_bin(in, MAZE_PACKED);
+    } else if (in[0] == '-' && in[1] == '\0') {
+        m = maze_read_flags(MAZE_PACKED);
+    } else {
+        m = maze_read_file(in, MAZE_PACKED);
+    }
+    if (!m) {
+        printf("Error reading maze\n");
+        return 1;
+    }
+
+    int err = 0;
+    if (to_text) {
+        maze_print(m, false);
+    } else {
+        err = maze_save_bin(m, argv[optind + 1]);
+        if (err) {
+            fprintf(stderr, "Error writing %s\n", argv[optind + 1]);
+        }
+    }
+
+    maze_cleanup(m);
+    return err;
+}
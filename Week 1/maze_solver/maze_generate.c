@@ -0,0 +1,421 @@
+// Needed for getopt()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "maze.h"
+#include "parent_map.h"
+#include "stack.h"
+
+/* Generates a maze in the text format read by maze_read() and writes it to
+ * stdout.
+ *
+ *   maze_generate [-a algorithm] [-s seed] [-l density] rows [cols]
+ *
+ * The algorithms are 'backtracker' (recursive backtracker, long winding
+ * corridors), 'wilson' (Wilson's algorithm, a uniformly random spanning tree)
+ * and 'eller' (Eller's algorithm). Eller's algorithm builds the maze one row
+ * at a time and only keeps one row in memory, so it can stream mazes of any
+ * size. The other two build the maze bit-packed in memory first.
+ *
+ * Cells are the odd rows and columns, the walls between them are opened to
+ * connect the cells. The result is a perfect maze, with exactly one path
+ * between any two cells. Every wall between two cells that is left is then
+ * opened with probability 'density', which adds loops (a braided maze).
+ * The maze is square unless the number of columns is given. An even number
+ * of rows or columns is rounded up to the next odd number. The start is the
+ * upper left cell and the destination the lower right cell.
+ */
+
+/* Upper bound on the cells of a maze built in memory, so cell indices fit
+ * in an int. */
+#define MAX_CELLS INT32_MAX
+
+#define USAGE "usage: %s [-a backtracker|wilson|eller] [-s seed] " \
+              "[-l density] rows [cols]\n"
+
+/* State of the xorshift64* random number generator. */
+static uint64_t random_state;
+
+/* Returns the next 64 random bits. */
+static uint64_t next_random(void) {
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * UINT64_C(2685821657736338717);
+}
+
+/* Returns a random number in [0, bound). */
+static int random_below(int bound) {
+    return (int) ((next_random() >> 32) * (uint64_t) bound >> 32);
+}
+
+/* Returns true with probability 'p'. */
+static bool random_chance(double p) {
+    return (double) (next_random() >> 11) * 0x1.0p-53 < p;
+}
+
+/* Opens the cell (r, c) of maze 'm' and the wall between it and the cell two
+ * steps away in direction 'move'. */
+static void carve(struct maze *m, int r, int c, int move) {
+    maze_set(m, r + m_offsets[move][0], c + m_offsets[move][1], FLOOR);
+    maze_set(m, r + 2 * m_offsets[move][0], c + 2 * m_offsets[move][1],
+             FLOOR);
+}
+
+/* Returns true if the cell two steps from (r, c) in direction 'move' is in
+ * the maze. */
+static bool cell_in_maze(const struct maze *m, int r, int c, int move) {
+    return maze_valid_move(m, r + 2 * m_offsets[move][0],
+                           c + 2 * m_offsets[move][1]);
+}
+
+/* Carves a perfect maze into 'm' with a depth first search that moves to a
+ * random unvisited neighbour cell and backtracks at dead ends.
+ * Returns 0 if successful, 1 otherwise. */
+static int backtracker(struct maze *m) {
+    size_t n_cells = (size_t) (maze_rows(m) / 2) * (size_t) (maze_cols(m) / 2);
+    struct stack *s = stack_init(n_cells);
+    if (s == NULL) {
+        return 1;
+    }
+
+    maze_set(m, 1, 1, FLOOR);
+    stack_push(s, maze_index(m, 1, 1));
+    while (!stack_empty(s)) {
+        int i = stack_peek(s);
+        int r = maze_row(m, i);
+        int c = maze_col(m, i);
+
+        // Pick one of the closed neighbour cells at random
+        int moves[N_MOVES];
+        int n_moves = 0;
+        for (int move = 0; move < N_MOVES; move++) {
+            if (cell_in_maze(m, r, c, move)
+                && maze_get(m, r + 2 * m_offsets[move][0],
+                            c + 2 * m_offsets[move][1]) == WALL) {
+                moves[n_moves++] = move;
+            }
+        }
+        if (n_moves == 0) {
+            stack_pop(s);
+            continue;
+        }
+
+        int move = moves[random_below(n_moves)];
+        carve(m, r, c, move);
+        stack_push(s, maze_index(m, r + 2 * m_offsets[move][0],
+                                 c + 2 * m_offsets[move][1]));
+    }
+
+    stack_cleanup(s);
+    return 0;
+}
+
+/* Carves a uniformly random perfect maze into 'm' with Wilson's algorithm:
+ * a random walk from every cell that is not in the maze yet until it hits
+ * the maze, with its loops erased, is added to the maze.
+ * Returns 0 if successful, 1 otherwise. */
+static int wilson(struct maze *m) {
+    int rows = maze_rows(m);
+    int cols = maze_cols(m);
+
+    // The last move out of every cell of the walk. A loop is erased by
+    // overwriting the move when the walk comes back to a cell.
+    struct parent_map *exits = parent_map_init(maze_cells(m));
+    if (exits == NULL) {
+        return 1;
+    }
+
+    maze_set(m, 1, 1, FLOOR);
+    for (int r_first = 1; r_first < rows - 1; r_first += 2) {
+        for (int c_first = 1; c_first < cols - 1; c_first += 2) {
+            int r = r_first;
+            int c = c_first;
+            while (maze_get(m, r, c) == WALL) {
+                int move;
+                do {
+                    move = random_below(N_MOVES);
+                } while (!cell_in_maze(m, r, c, move));
+                parent_map_set(exits, maze_index(m, r, c), move);
+                r += 2 * m_offsets[move][0];
+                c += 2 * m_offsets[move][1];
+            }
+
+            // Add the loop-erased walk to the maze
+            r = r_first;
+            c = c_first;
+            while (maze_get(m, r, c) == WALL) {
+                int move = parent_map_get(exits, maze_index(m, r, c));
+                maze_set(m, r, c, FLOOR);
+                maze_set(m, r + m_offsets[move][0], c + m_offsets[move][1],
+                         FLOOR);
+                r += 2 * m_offsets[move][0];
+                c += 2 * m_offsets[move][1];
+            }
+        }
+    }
+
+    parent_map_cleanup(exits);
+    return 0;
+}
+
+/* Opens every wall between two cells of 'm' with probability 'density'. */
+static void add_loops(struct maze *m, double density) {
+    int rows = maze_rows(m);
+    int cols = maze_cols(m);
+    for (int r = 1; r < rows - 1; r++) {
+        // Walls between cells have one odd and one even coordinate
+        for (int c = r % 2 ? 2 : 1; c < cols - 1; c += 2) {
+            if (maze_get(m, r, c) == WALL && random_chance(density)) {
+                maze_set(m, r, c, FLOOR);
+            }
+        }
+    }
+}
+
+/* Generates a maze of 'rows' by 'cols' in memory with 'algorithm' and
+ * prints it.
+ * Returns 0 if successful, 1 otherwise. */
+static int generate_in_memory(int rows, int cols,
+                              int (*algorithm)(struct maze *),
+                              double density) {
+    struct maze *m = maze_init_rect(rows, cols, MAZE_PACKED);
+    if (m == NULL) {
+        return 1;
+    }
+
+    if (algorithm(m)) {
+        maze_cleanup(m);
+        return 1;
+    }
+    add_loops(m, density);
+
+    // maze_init_rect() already put the start and destination in the corners
+    maze_print(m, false);
+    maze_cleanup(m);
+    return 0;
+}
+
+/* Returns the set of 'label' in the union-find forest 'parent'. */
+static int find_set(int *parent, int label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+/* Writes the text line of 'n' characters in 'line' to stdout.
+ * Returns 0 if successful, 1 otherwise. */
+static int put_line(char *line, int n) {
+    line[n] = '\n';
+    return fwrite(line, 1, (size_t) n + 1, stdout) != (size_t) n + 1;
+}
+
+/* Streams a maze of 'rows' by 'n' columns to stdout with Eller's algorithm.
+ * Every cell of the current row has a set label, cells with the same label
+ * are connected through the rows above. Neighbours in different sets are
+ * joined at random, then every set continues to the next row through at
+ * least one cell. The cells that do not continue get fresh labels. The last
+ * row joins all remaining sets. Memory use is linear in the width.
+ * Returns 0 if successful, 1 otherwise. */
+static int eller(int rows, int n, double density) {
+    int k = n / 2; // cells per row
+    int k_rows = rows / 2;
+    size_t k_size = (size_t) k;
+    int *label = malloc(k_size * sizeof(int));
+    int *parent = malloc(k_size * sizeof(int));
+    int *count = malloc(k_size * sizeof(int));
+    int *pick = malloc(k_size * sizeof(int));
+    int *free_labels = malloc(k_size * sizeof(int));
+    bool *right = malloc(k_size);
+    bool *down = malloc(k_size);
+    bool *has_down = malloc(k_size);
+    char *line = malloc((size_t) n + 1);
+    int status = 0;
+    if (!label || !parent || !count || !pick || !free_labels || !right
+        || !down || !has_down || !line) {
+        status = 1;
+        k = 0;
+    }
+
+    for (int j = 0; j < k; j++) {
+        label[j] = j;
+        parent[j] = j;
+    }
+    if (k > 0) {
+        memset(line, WALL, (size_t) n);
+        status |= put_line(line, n);
+    }
+
+    for (int i = 0; i < k_rows && status == 0; i++) {
+        bool last = i == k_rows - 1;
+
+        // Join neighbours in different sets, always in the last row
+        for (int j = 0; j + 1 < k; j++) {
+            int a = find_set(parent, label[j]);
+            int b = find_set(parent, label[j + 1]);
+            right[j] = a != b && (last || random_below(2));
+            if (right[j]) {
+                parent[b] = a;
+            }
+        }
+        for (int j = 0; j < k; j++) {
+            label[j] = find_set(parent, label[j]);
+            count[label[j]] = 0;
+            has_down[label[j]] = false;
+        }
+
+        // Every set goes down at random cells and at one cell at least,
+        // picked uniformly from its cells
+        for (int j = 0; j < k; j++) {
+            int l = label[j];
+            down[j] = !last && random_below(2);
+            has_down[l] |= down[j];
+            count[l]++;
+            if (random_below(count[l]) == 0) {
+                pick[l] = j;
+            }
+        }
+        for (int j = 0; j < k && !last; j++) {
+            if (!has_down[label[j]]) {
+                down[pick[label[j]]] = true;
+                has_down[label[j]] = true;
+            }
+        }
+
+        // Cell row and the wall row below it
+        line[0] = WALL;
+        for (int j = 0; j < k; j++) {
+            line[2 * j + 1] = FLOOR;
+            line[2 * j + 2] = j + 1 < k
+                              && (right[j] || random_chance(density))
+                              ? FLOOR : WALL;
+        }
+        line[n - 1] = WALL;
+        if (last) {
+            line[n - 2] = FINISH;
+        }
+        if (i == 0) {
+            line[1] = START;
+        }
+        status |= put_line(line, n);
+
+        memset(line, WALL, (size_t) n);
+        for (int j = 0; j < k && !last; j++) {
+            if (down[j] || random_chance(density)) {
+                line[2 * j + 1] = FLOOR;
+            }
+        }
+        status |= put_line(line, n);
+
+        // Cells that do not go down start a new set in the next row
+        for (int j = 0; j < k; j++) {
+            count[j] = 0;
+        }
+        for (int j = 0; j < k; j++) {
+            if (down[j]) {
+                count[label[j]] = 1;
+            }
+        }
+        int n_free = 0;
+        for (int l = 0; l < k; l++) {
+            if (!count[l]) {
+                free_labels[n_free++] = l;
+            }
+            parent[l] = l;
+        }
+        for (int j = 0; j < k; j++) {
+            if (!down[j]) {
+                label[j] = free_labels[--n_free];
+            }
+        }
+    }
+
+    free(label);
+    free(parent);
+    free(count);
+    free(pick);
+    free(free_labels);
+    free(right);
+    free(down);
+    free(has_down);
+    free(line);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    /* -a selects the algorithm: backtracker (default), wilson or eller,
+     * -s sets the random seed,
+     * -l sets the probability that a wall between cells is opened */
+    const char *algorithm = "backtracker";
+    uint64_t seed = 1;
+    double density = 0.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:s:l:")) != -1) {
+        switch (opt) {
+        case 'a':
+            algorithm = optarg;
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'l':
+            density = atof(optarg);
+            break;
+        default:
+            fprintf(stderr, USAGE, argv[0]);
+            return 1;
+        }
+    }
+    if (optind + 1 != argc && optind + 2 != argc) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    long n_rows = atol(argv[optind]);
+    long n_cols = optind + 2 == argc ? atol(argv[optind + 1]) : n_rows;
+    if (n_rows < 3 || n_cols < 3) {
+        fprintf(stderr, "The size must be at least 3\n");
+        return 1;
+    }
+    if (n_rows > INT32_MAX - 1 || n_cols > INT32_MAX - 1) {
+        fprintf(stderr, "The size must be at most %d\n", INT32_MAX - 1);
+        return 1;
+    }
+    int rows = (int) (n_rows | 1);
+    int cols = (int) (n_cols | 1);
+
+    // xorshift needs a state that is not zero, mix the seed to get one
+    random_state = (seed + 1) * UINT64_C(0x9E3779B97F4A7C15);
+
+    int err;
+    if (strcmp(algorithm, "eller") == 0) {
+        err = eller(rows, cols, density);
+    } else {
+        if ((int64_t) rows * cols > MAX_CELLS) {
+            fprintf(stderr, "The maze must have at most %d cells, "
+                    "use -a eller for larger mazes\n", MAX_CELLS);
+            return 1;
+        }
+        if (strcmp(algorithm, "backtracker") == 0) {
+            err = generate_in_memory(rows, cols, backtracker, density);
+        } else if (strcmp(algorithm, "wilson") == 0) {
+            err = generate_in_memory(rows, cols, wilson, density);
+        } else {
+            fprintf(stderr, "Unknown algorithm %s\n", algorithm);
+            return 1;
+        }
+    }
+
+    if (err) {
+        fprintf(stderr, "Error generating maze\n");
+    }
+    return err;
+}
@@ -0,0 +1,76 @@
+#include <getopt.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver.h"
+#include "search.h"
+
+/* A search the driver can run, selected by name with --algo. */
+struct algorithm {
+    const char *name;
+    int (*solve)(struct maze *m, bool print_stats);
+    int (*solve_path)(struct maze *m, bool print_stats, struct path *path);
+};
+
+static const struct algorithm algorithms[] = {
+    {"bfs", bfs_solve, bfs_solve_path},
+    {"dfs", dfs_solve, dfs_solve_path},
+};
+
+#define N_ALGORITHMS (sizeof(algorithms) / sizeof(algorithms[0]))
+
+// The search selected with --algo, and whether -b runs it from both ends
+static const struct algorithm *algo = &algorithms[0];
+static bool bidirectional = false;
+
+/* Handles --algo and -b by pointing 'd' at the selected search. */
+static int option(struct driver *d, int opt, const char *arg) {
+    if (opt == 'a') {
+        const struct algorithm *found = NULL;
+        for (size_t i = 0; i < N_ALGORITHMS; i++) {
+            if (strcmp(algorithms[i].name, arg) == 0) {
+                found = &algorithms[i];
+            }
+        }
+        if (found == NULL) {
+            return 1;
+        }
+        algo = found;
+    } else if (opt == 'b') {
+        bidirectional = true;
+    } else {
+        return 1;
+    }
+
+    // Only breadth first search runs from both ends, and it marks its path
+    if (bidirectional && algo->solve != bfs_solve) {
+        return 1;
+    }
+    d->name = algo->name;
+    d->solve = bidirectional ? bfs_solve_bidirectional : algo->solve;
+    d->solve_path = bidirectional ? NULL : algo->solve_path;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    /* --algo (or -a) selects the search: bfs (default) or dfs,
+     * -b searches from both ends at the same time (bfs only, not with -o),
+     * see driver.h for the other options */
+    static const struct option long_options[] = {
+        {"algo", required_argument, NULL, 'a'},
+        {NULL, 0, NULL, 0},
+    };
+    struct driver d = {
+        .name = "bfs",
+        .solve = bfs_solve,
+        .solve_path = bfs_solve_path,
+        .options = "a:b",
+        .usage = "[--algo bfs|dfs] [-b] ",
+        .long_options = long_options,
+        .option = option,
+        .queries = true,
+        .large_mazes = true,
+    };
+    return driver_main(&d, argc, argv);
+}
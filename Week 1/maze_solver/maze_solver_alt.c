@@ -0,0 +1,268 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver.h"
+#include "index_heap.h"
+#include "landmarks.h"
+#include "maze.h"
+#include "parent_map.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* Default number of landmarks (-k). */
+#define DEFAULT_LANDMARKS 8
+
+/* The landmarks are kept in the maze file name with this suffix, unless -l
+ * names another file. */
+#define LANDMARKS_SUFFIX ".lmk"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* State of the searches on one maze. 'g' is the number of moves to an index
+ * in the current search if its 'stamp' holds the current 'epoch', otherwise
+ * the index is not reached yet. So a search only touches the cells it
+ * reaches and nothing is cleared between queries. */
+struct alt {
+    struct maze *m;
+    const struct landmarks *l;
+    struct index_heap *open;
+    struct parent_map *p;
+    int *g;
+    uint32_t *stamp;
+    uint32_t epoch;
+};
+
+/* Returns the key of a cell with 'g' moves from the start and bound 'h':
+ * the lowest g + h first and of those the one farthest from the start,
+ * which is closest to the destination. */
+static uint64_t open_key(int g, int h) {
+    return (uint64_t) (g + h) << 32 | (uint32_t) (INT_MAX - g);
+}
+
+/* Solves the maze from its start to its destination with A*, using the
+ * landmark bound of landmarks_bound() as heuristic. With scaled tables the
+ * bound is admissible but not always consistent, so a cell whose number of
+ * moves drops after it was expanded is opened again. Expanded cells are
+ * marked VISITED. With 'print_stats' the open list statistics of this search
+ * are printed to stderr.
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+static int alt_solve(struct alt *a, bool print_stats) {
+    struct maze *m = a->m;
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    int index_destination = maze_index(m, r_dest, c_dest);
+
+    // No bound means a landmark reaches one end but not the other
+    int h_start = landmarks_bound(a->l, r_start, c_start, r_dest, c_dest);
+    if (h_start < 0) {
+        return NOT_FOUND;
+    }
+
+    // A new epoch forgets every 'g' of the last search
+    if (++a->epoch == 0) {
+        memset(a->stamp, 0, maze_cells(m) * sizeof(uint32_t));
+        a->epoch = 1;
+    }
+    a->stamp[index_start] = a->epoch;
+    a->g[index_start] = 0;
+
+    // The heap counts every search, these only count this one
+    long n_pushes = 1;
+    long n_pops = 0;
+    size_t max_open = 1;
+
+    int result = NOT_FOUND;
+    if (index_heap_push(a->open, index_start, open_key(0, h_start))) {
+        debug_print("Could not push onto the open list in alt_solve");
+        result = ERROR;
+    }
+    while (result == NOT_FOUND && index_heap_size(a->open) > 0) {
+        int i = index_heap_pop(a->open);
+        n_pops++;
+        int r = maze_row(m, i);
+        int c = maze_col(m, i);
+        maze_set(m, r, c, VISITED);
+
+        if (i == index_destination) {
+            result = parent_map_trace(a->p, m, index_start, index_destination);
+            break;
+        }
+
+        int new_g = a->g[i] + 1;
+        for (int move = 0; move < N_MOVES; move++) {
+            int new_r = r + m_offsets[move][0];
+            int new_c = c + m_offsets[move][1];
+            if (!maze_valid_move(m, new_r, new_c)
+                || maze_get(m, new_r, new_c) == WALL) {
+                continue;
+            }
+            int j = maze_index(m, new_r, new_c);
+            if (a->stamp[j] == a->epoch && a->g[j] <= new_g) {
+                continue;
+            }
+            int h = landmarks_bound(a->l, new_r, new_c, r_dest, c_dest);
+            if (h < 0) {
+                continue;
+            }
+            a->stamp[j] = a->epoch;
+            a->g[j] = new_g;
+            parent_map_set(a->p, j, move);
+            if (index_heap_push(a->open, j, open_key(new_g, h))) {
+                debug_print("Could not push onto the open list in alt_solve");
+                result = ERROR;
+                break;
+            }
+            n_pushes++;
+        }
+        if (index_heap_size(a->open) > max_open) {
+            max_open = index_heap_size(a->open);
+        }
+    }
+
+    if (print_stats) {
+        fprintf(stderr, "stats %ld %ld %zu\n", n_pushes, n_pops, max_open);
+    }
+
+    // Leave the open list empty for the next search
+    while (index_heap_size(a->open) > 0) {
+        index_heap_pop(a->open);
+    }
+    return result;
+}
+
+/* Sets up 'a' for searches on maze 'm' with the landmarks 'l'.
+ * Returns 0 if successful, 1 otherwise. */
+static int alt_init(struct alt *a, struct maze *m,
+                    const struct landmarks *l) {
+    size_t n_cells = maze_cells(m);
+    a->m = m;
+    a->l = l;
+    a->open = index_heap_init(n_cells);
+    a->p = parent_map_init(n_cells);
+    a->g = malloc(n_cells * sizeof(int));
+    a->stamp = calloc(n_cells, sizeof(uint32_t));
+    a->epoch = 0;
+    return !a->open || !a->p || !a->g || !a->stamp;
+}
+
+static void alt_cleanup(struct alt *a) {
+    if (a->open) {
+        index_heap_cleanup(a->open);
+    }
+    if (a->p) {
+        parent_map_cleanup(a->p);
+    }
+    free(a->g);
+    free(a->stamp);
+}
+
+/* Loads the landmarks of 'm' from 'path', or if that file is missing or was
+ * made for another maze, picks 'count' new ones and saves them there. With
+ * no 'path' the new landmarks are not saved.
+ * Returns the landmarks or NULL if an error occured. */
+static struct landmarks *get_landmarks(struct maze *m, const char *path,
+                                       int count) {
+    struct landmarks *l = path ? landmarks_load(m, path) : NULL;
+    if (l) {
+        return l;
+    }
+
+    l = landmarks_init(m, count);
+    if (l && path && landmarks_save(l, path)) {
+        fprintf(stderr, "Cannot save landmarks to %s\n", path);
+    }
+    return l;
+}
+
+// Number of new landmarks (-k) and their file (-l)
+static int n_landmarks = DEFAULT_LANDMARKS;
+static const char *landmark_file = NULL;
+
+// The landmarks and the searches of the maze, made by setup()
+static struct landmarks *landmarks = NULL;
+static struct alt searches;
+
+/* Handles -k, the number of new landmarks, and -l, their file. */
+static int option(struct driver *d, int opt, const char *arg) {
+    (void) d;
+    if (opt == 'k') {
+        n_landmarks = atoi(arg);
+        return n_landmarks < 1 || n_landmarks > MAX_LANDMARKS;
+    }
+    if (opt == 'l') {
+        landmark_file = arg;
+        return 0;
+    }
+    return 1;
+}
+
+/* Loads or builds the landmarks of 'm', by default next to 'maze_file', and
+ * sets up the searches before they are timed. */
+static int setup(struct maze *m, const char *maze_file, bool print_stats) {
+    (void) print_stats;
+    char *path = NULL;
+    const char *file = landmark_file;
+    if (!file && maze_file) {
+        path = malloc(strlen(maze_file) + sizeof(LANDMARKS_SUFFIX));
+        if (!path) {
+            return 1;
+        }
+        strcpy(path, maze_file);
+        strcat(path, LANDMARKS_SUFFIX);
+        file = path;
+    }
+    landmarks = get_landmarks(m, file, n_landmarks);
+    free(path);
+    if (!landmarks) {
+        return 1;
+    }
+    if (alt_init(&searches, m, landmarks)) {
+        alt_cleanup(&searches);
+        landmarks_cleanup(landmarks);
+        return 1;
+    }
+    return 0;
+}
+
+static int solve(struct maze *m, bool print_stats) {
+    (void) m;
+    return alt_solve(&searches, print_stats);
+}
+
+static void cleanup(void) {
+    alt_cleanup(&searches);
+    landmarks_cleanup(landmarks);
+}
+
+int main(int argc, char *argv[]) {
+    /* -k sets the number of landmarks of new landmarks,
+     * -l sets the landmark file (default: the maze file with .lmk added,
+     *    none for a maze read from stdin),
+     * see driver.h for the other options */
+    struct driver d = {
+        .name = "alt",
+        .solve = solve,
+        .options = "k:l:",
+        .usage = "[-k landmarks] [-l landmark_file] ",
+        .option = option,
+        .setup = setup,
+        .cleanup = cleanup,
+        .queries = true,
+    };
+    return driver_main(&d, argc, argv);
+}
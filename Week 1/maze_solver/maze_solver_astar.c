@@ -0,0 +1,146 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "bucket_queue.h"
+#include "driver.h"
+#include "maze.h"
+#include "parent_map.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* With unit moves and the Manhattan distance as heuristic, a move changes
+ * f = g + h by 0 or 2, so the open keys never spread over more than three
+ * consecutive values. */
+#define N_BUCKETS 3
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Returns the Manhattan distance from (r, c) to (r_dest, c_dest). */
+static int manhattan(int r, int c, int r_dest, int c_dest) {
+    return abs(r - r_dest) + abs(c - c_dest);
+}
+
+/* Checks if the given move leads to a tile that is not a wall and not
+   expanded yet, and if the path through the current tile is shorter than any
+   path to it found before. In that case its distance 'g' and the move into it
+   are updated and it is added to the open list with key g + h.
+*/
+int check_neighbour(struct maze *m, struct bucket_queue *bq,
+                    struct parent_map *p, int *g, int r_dest, int c_dest,
+                    int move, int current_index) {
+    int new_r = maze_row(m, current_index) + m_offsets[move][0];
+    int new_c = maze_col(m, current_index) + m_offsets[move][1];
+    if (!maze_valid_move(m, new_r, new_c)) {
+        return 0;
+    }
+
+    char new_position = maze_get(m, new_r, new_c);
+    int new_index = maze_index(m, new_r, new_c);
+    int new_g = g[current_index] + 1;
+    if (new_position == FLOOR && new_g < g[new_index]) {
+        g[new_index] = new_g;
+        parent_map_set(p, new_index, move);
+
+        int key = new_g + manhattan(new_r, new_c, r_dest, c_dest);
+        if (bucket_queue_push(bq, key, new_index) == 1) {
+            debug_print("Could not push to bucket queue in check_neighbour");
+            return ERROR;
+        }
+    }
+
+    return 0;
+}
+
+/* Solves the maze m with A*, using the Manhattan distance to the destination
+ * as heuristic. Expanded tiles are marked VISITED. Tiles can be pushed more
+ * than once when a shorter path to them is found, stale entries are skipped
+ * when they are popped because the tile is already VISITED.
+ * With 'print_stats' the open list statistics are printed to stderr.
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int astar_solve(struct maze *m, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in astar_solve");
+        return ERROR;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    int index_destination = maze_index(m, r_dest, c_dest);
+
+    size_t n_cells = maze_cells(m);
+    struct bucket_queue *bq = bucket_queue_init(N_BUCKETS);
+    struct parent_map *p = parent_map_init(n_cells);
+    int *g = malloc(n_cells * sizeof(int));
+    if (bq == NULL || p == NULL || g == NULL) {
+        debug_print("Could not initialize astar_solve");
+        free(g);
+        parent_map_cleanup(p);
+        bucket_queue_cleanup(bq);
+        return ERROR;
+    }
+    for (size_t i = 0; i < n_cells; i++) {
+        g[i] = INT_MAX;
+    }
+
+    int result = NOT_FOUND;
+    g[index_start] = 0;
+    if (bucket_queue_push(bq, manhattan(r_start, c_start, r_dest, c_dest),
+                          index_start) == 1) {
+        debug_print("Could not push element onto bucket queue in astar_solve");
+        result = ERROR;
+    }
+
+    while (result == NOT_FOUND && !bucket_queue_empty(bq)) {
+        int i = bucket_queue_pop(bq, NULL);
+        int r = maze_row(m, i);
+        int c = maze_col(m, i);
+        if (maze_get(m, r, c) == VISITED) {
+            continue;
+        }
+        maze_set(m, r, c, VISITED);
+
+        if (i == index_destination) {
+            result = parent_map_trace(p, m, index_start, index_destination);
+            break;
+        }
+
+        for (int move = 0; move < N_MOVES; move++) {
+            if (check_neighbour(m, bq, p, g, r_dest, c_dest, move, i)
+                == ERROR) {
+                debug_print("Could not check neighbour in astar_solve");
+                result = ERROR;
+                break;
+            }
+        }
+    }
+
+    if (print_stats) {
+        bucket_queue_stats(bq);
+    }
+    free(g);
+    parent_map_cleanup(p);
+    bucket_queue_cleanup(bq);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    /* see driver.h for the options */
+    struct driver d = {
+        .name = "astar",
+        .solve = astar_solve,
+    };
+    return driver_main(&d, argc, argv);
+}
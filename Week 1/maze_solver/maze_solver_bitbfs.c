@@ -0,0 +1,297 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver.h"
+#include "maze.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* Size of a cache line and of a struct block. */
+#define CACHE_LINE 64
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* The state of 64 tiles of one row in a bit-parallel BFS, bit c % 64 of a
+ * block of row r is column c of that row. All bitmaps of a block share one
+ * cache line: the struct is padded to CACHE_LINE bytes and the blocks are
+ * allocated on a line boundary, so a word operation on a block touches one
+ * line.
+ *
+ * 'open' has the tiles that can be entered, 'visited' the tiles reached so
+ * far, 'frontier' the tiles of the current level and 'next' the tiles of the
+ * level being computed. For every visited tile its distance modulo 3 is kept
+ * in the two bit planes 'level_lo' and 'level_hi'. The neighbours of a tile
+ * at distance d are at distance d - 1, d or d + 1, so modulo 3 is enough to
+ * find a predecessor afterwards. */
+struct block {
+    uint64_t open;
+    uint64_t visited;
+    uint64_t frontier;
+    uint64_t next;
+    uint64_t level_lo;
+    uint64_t level_hi;
+    uint64_t unused[2];
+};
+
+/* One bit-parallel BFS over 'rows' rows of 'words' blocks for 'cols'
+ * columns. Blocks are numbered r * words + w, only the blocks in 'active'
+ * have frontier bits, 'n_frontier' tiles in all. 'next_active' lists the
+ * blocks with 'next' bits while a level is computed. */
+struct bitbfs {
+    int rows;
+    int cols;
+    size_t words;
+    struct block *blocks;
+
+    size_t *active;
+    size_t n_active;
+    size_t *next_active;
+    size_t n_next_active;
+    long n_frontier;
+};
+
+static struct block *block_of(const struct bitbfs *b, int r, int c) {
+    return &b->blocks[(size_t) r * b->words + (size_t) c / 64];
+}
+
+static bool bit_test(uint64_t bits, int c) {
+    return (bits >> (c % 64)) & 1;
+}
+
+/* Returns the distance modulo 3 stored for (r, c). */
+static int level_of(const struct bitbfs *b, int r, int c) {
+    const struct block *k = block_of(b, r, c);
+    return bit_test(k->level_lo, c) | bit_test(k->level_hi, c) << 1;
+}
+
+/* Fills in the 'open' bits: every tile that is not a wall and not on the
+ * border. Returns 0 if successful, 1 otherwise. */
+static int build_open(struct bitbfs *b, const struct maze *m) {
+    uint64_t *row = malloc(b->words * sizeof(uint64_t));
+    if (row == NULL) {
+        return 1;
+    }
+    for (int r = 1; r < b->rows - 1; r++) {
+        maze_wall_row(m, r, row);
+        // The first and last column are border
+        row[0] |= UINT64_C(1);
+        int last = b->cols - 1;
+        row[(size_t) last / 64] |= UINT64_C(1) << (last % 64);
+        for (size_t w = 0; w < b->words; w++) {
+            b->blocks[(size_t) r * b->words + w].open = ~row[w];
+        }
+    }
+    free(row);
+    return 0;
+}
+
+/* Adds the tiles 'bits' to the next level of block 'k', except those that
+ * are not open or already visited. A block that gets its first next bits is
+ * added to 'next_active'. */
+static void reach(struct bitbfs *b, size_t k, uint64_t bits) {
+    struct block *block = &b->blocks[k];
+    bits &= block->open & ~block->visited;
+    if (bits == 0) {
+        return;
+    }
+    if (block->next == 0) {
+        b->next_active[b->n_next_active++] = k;
+    }
+    block->next |= bits;
+}
+
+/* Spreads the frontier of block 'k' to its neighbours: the bits shifted
+ * left and right within the block, the bits on its edges into the blocks
+ * to the left and right, and the bits as they are into the blocks above
+ * and below. Only blocks that get a bit are touched. */
+static void expand_block(struct bitbfs *b, size_t k) {
+    uint64_t f = b->blocks[k].frontier;
+
+    reach(b, k, f << 1 | f >> 1);
+    // Only a bit on an edge crosses into the next block of the row
+    if ((f & 1) && k % b->words > 0) {
+        reach(b, k - 1, UINT64_C(1) << 63);
+    }
+    if (f >> 63 && k % b->words < b->words - 1) {
+        reach(b, k + 1, UINT64_C(1));
+    }
+    if (k >= b->words) {
+        reach(b, k - b->words, f);
+    }
+    if (k + b->words < (size_t) b->rows * b->words) {
+        reach(b, k + b->words, f);
+    }
+}
+
+/* Advances the search one level, to distance 'level'. The frontier moves to
+ * the blocks that got new tiles. Returns the number of blocks in the new
+ * frontier. */
+static size_t step(struct bitbfs *b, int level) {
+    b->n_next_active = 0;
+    for (size_t i = 0; i < b->n_active; i++) {
+        expand_block(b, b->active[i]);
+    }
+
+    // The old frontier blocks are replaced by the new ones
+    for (size_t i = 0; i < b->n_active; i++) {
+        b->blocks[b->active[i]].frontier = 0;
+    }
+    uint64_t lo = level % 3 & 1 ? ~UINT64_C(0) : 0;
+    uint64_t hi = level % 3 & 2 ? ~UINT64_C(0) : 0;
+    b->n_frontier = 0;
+    for (size_t i = 0; i < b->n_next_active; i++) {
+        struct block *k = &b->blocks[b->next_active[i]];
+        b->n_frontier += __builtin_popcountll(k->next);
+        k->frontier = k->next;
+        k->visited |= k->next;
+        k->level_lo |= k->next & lo;
+        k->level_hi |= k->next & hi;
+        k->next = 0;
+    }
+
+    size_t *active = b->active;
+    b->active = b->next_active;
+    b->next_active = active;
+    b->n_active = b->n_next_active;
+    return b->n_active;
+}
+
+/* Marks the visited tiles VISITED and walks back from the destination at
+ * distance 'length', every time to a neighbour one level closer to the
+ * start, marking those tiles PATH. The VISITED marks are written a row at a
+ * time into the cells of maze_data() if the maze has them. */
+static void mark_maze(const struct bitbfs *b, struct maze *m, int r_start,
+                      int c_start, int r, int c, int length) {
+    char *cells = maze_data(m);
+    for (int row = 0; row < b->rows; row++) {
+        char *line = cells ? cells + (size_t) row * (size_t) b->cols : NULL;
+        for (size_t w = 0; w < b->words; w++) {
+            uint64_t bits = b->blocks[(size_t) row * b->words + w].visited;
+            for (; bits; bits &= bits - 1) {
+                int col = (int) w * 64 + __builtin_ctzll(bits);
+                if (line) {
+                    line[col] = VISITED;
+                } else {
+                    maze_set(m, row, col, VISITED);
+                }
+            }
+        }
+    }
+
+    while (r != r_start || c != c_start) {
+        length--;
+        for (int move = 0; move < N_MOVES; move++) {
+            int new_r = r - m_offsets[move][0];
+            int new_c = c - m_offsets[move][1];
+            if (bit_test(block_of(b, new_r, new_c)->visited, new_c)
+                && level_of(b, new_r, new_c) == length % 3) {
+                r = new_r;
+                c = new_c;
+                break;
+            }
+        }
+        maze_set(m, r, c, PATH);
+    }
+}
+
+static void cleanup(struct bitbfs *b) {
+    free(b->blocks);
+    free(b->active);
+    free(b->next_active);
+}
+
+/* Solves the maze m with a breadth first search that advances a whole level
+ * at a time with bitwise operations on row bitmaps: the next level is the
+ * frontier shifted up, down, left and right, restricted to open tiles that
+ * are not visited yet. That handles 64 tiles per word operation instead of
+ * checking one neighbour at a time, but only where a level has many tiles
+ * in one word. In a corridor maze or an open room a level is thin, a few
+ * tiles per word, and bfs_solve() is about as fast or faster. The distances
+ * are the ones of bfs_solve(), so the path has the same length. With
+ * 'print_stats' the tiles reached, the tiles expanded and the largest level
+ * are printed to stderr like the frontier statistics of bfs_solve().
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int bitbfs_solve(struct maze *m, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in bitbfs_solve");
+        return ERROR;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    if (r_start == r_dest && c_start == c_dest) {
+        return 0;
+    }
+
+    struct bitbfs b = { .rows = maze_rows(m), .cols = maze_cols(m) };
+    b.words = ((size_t) b.cols + 63) / 64;
+    size_t total = (size_t) b.rows * b.words;
+    b.blocks = aligned_alloc(CACHE_LINE, total * sizeof(struct block));
+    if (b.blocks) {
+        memset(b.blocks, 0, total * sizeof(struct block));
+    }
+    // Every block is listed at most once per level
+    b.active = malloc(total * sizeof(size_t));
+    b.next_active = malloc(total * sizeof(size_t));
+    if (!b.blocks || !b.active || !b.next_active || build_open(&b, m) != 0) {
+        debug_print("Could not initialize bitbfs_solve");
+        cleanup(&b);
+        return ERROR;
+    }
+
+    int result = NOT_FOUND;
+    if (maze_valid_move(m, r_start, c_start)) {
+        struct block *k = block_of(&b, r_start, c_start);
+        k->frontier = k->visited = UINT64_C(1) << (c_start % 64);
+        b.active[0] = (size_t) (k - b.blocks);
+        b.n_active = 1;
+        b.n_frontier = 1;
+    }
+
+    // Every tile of a level is reached once and expanded in the next level
+    long n_pushes = b.n_frontier;
+    long n_pops = 0;
+    long max_frontier = b.n_frontier;
+    for (int level = 1; b.n_active > 0; level++) {
+        n_pops += b.n_frontier;
+        step(&b, level);
+        n_pushes += b.n_frontier;
+        if (b.n_frontier > max_frontier) {
+            max_frontier = b.n_frontier;
+        }
+        if (bit_test(block_of(&b, r_dest, c_dest)->visited, c_dest)) {
+            mark_maze(&b, m, r_start, c_start, r_dest, c_dest, level);
+            result = level;
+            break;
+        }
+    }
+
+    if (print_stats) {
+        fprintf(stderr, "stats %ld %ld %ld\n", n_pushes, n_pops,
+                max_frontier);
+    }
+    cleanup(&b);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    /* see driver.h for the options */
+    struct driver d = {
+        .name = "bitbfs",
+        .solve = bitbfs_solve,
+        .large_mazes = true,
+    };
+    return driver_main(&d, argc, argv);
+}
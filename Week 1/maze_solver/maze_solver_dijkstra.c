@@ -0,0 +1,234 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "bucket_queue.h"
+#include "driver.h"
+#include "maze.h"
+#include "parent_map.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* A move costs at most MAX_COST, so the open keys never spread over more
+ * than MAX_COST + 1 consecutive values. */
+#define N_BUCKETS (MAX_COST + 1)
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+// Cost of the last path found, printed after its length
+static int path_cost = 0;
+
+/* State of one search. 'costs' are those of maze_costs() and 'g' holds the
+ * lowest cost found to every index so far. Without costs 'g' is NULL: every
+ * move costs 1, so a cell gets its lowest cost when it is first reached and
+ * is marked VISITED and pushed only then, like in bfs_solve(). */
+struct dial {
+    struct bucket_queue *bq;
+    struct parent_map *p;
+    const uint8_t *costs;
+    int *g;
+};
+
+/* Returns the cost of moving onto 'index'. */
+static inline int cost_of(const struct dial *d, int index) {
+    if (!d->costs) {
+        return 1;
+    }
+    return ((d->costs[index / 2] >> (4 * (index % 2))) & 0xf) + 1;
+}
+
+/* Reaches the cell at 'index' with 'move' for a total cost of 'new_g'. It
+ * is pushed with key 'new_g' unless a cheaper way to it is known.
+ * Returns 1 if it is pushed, 0 if it is not and ERROR if the bucket queue
+ * could not grow. */
+static inline int reach(struct dial *d, int index, int move, int new_g) {
+    if (d->g) {
+        if (new_g >= d->g[index]) {
+            return 0;
+        }
+        d->g[index] = new_g;
+    }
+    parent_map_set(d->p, index, move);
+    if (bucket_queue_push(d->bq, new_g, index) == 1) {
+        debug_print("Could not push to bucket queue in reach");
+        return ERROR;
+    }
+    return 1;
+}
+
+/* Reaches every FLOOR neighbour of the cell at 'i', which costs 'g_i'.
+ * Works on the raw 'cells' of maze_data() with the index 'deltas', the WALL
+ * border keeps every neighbour inside the maze.
+ * Returns 0 if successful, ERROR otherwise. */
+static inline int expand_cells(struct dial *d, char *cells,
+                               const int deltas[N_MOVES], int i, int g_i) {
+    for (int move = 0; move < N_MOVES; move++) {
+        int new_index = i + deltas[move];
+        if (cells[new_index] != FLOOR) {
+            continue;
+        }
+        int pushed = reach(d, new_index, move, g_i + cost_of(d, new_index));
+        if (pushed == ERROR) {
+            return ERROR;
+        }
+        if (pushed && !d->g) {
+            cells[new_index] = VISITED;
+        }
+    }
+    return 0;
+}
+
+/* Same as expand_cells(), through the maze interface, for mazes without
+ * maze_data(). */
+static int expand_maze(struct dial *d, struct maze *m, int i, int g_i) {
+    int r = maze_row(m, i);
+    int c = maze_col(m, i);
+    for (int move = 0; move < N_MOVES; move++) {
+        int new_r = r + m_offsets[move][0];
+        int new_c = c + m_offsets[move][1];
+        if (!maze_valid_move(m, new_r, new_c)
+            || maze_get(m, new_r, new_c) != FLOOR) {
+            continue;
+        }
+        int new_index = maze_index(m, new_r, new_c);
+        int pushed = reach(d, new_index, move, g_i + cost_of(d, new_index));
+        if (pushed == ERROR) {
+            return ERROR;
+        }
+        if (pushed && !d->g) {
+            maze_set(m, new_r, new_c, VISITED);
+        }
+    }
+    return 0;
+}
+
+/* Solves the maze m with Dijkstra's algorithm on a circular bucket queue
+ * (Dial's algorithm): moving onto a cell costs maze_cost(), so the keys are
+ * small integers. With costs a cell can be pushed more than once, stale
+ * entries are skipped when they are popped because a cheaper way to the cell
+ * is known. Expanded cells are marked VISITED and the path is marked PATH.
+ * The number of moves of the path is stored in 'length'. With 'print_stats'
+ * the open list statistics are printed to stderr.
+ * Returns the cost of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int dijkstra_solve(struct maze *m, int *length, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in dijkstra_solve");
+        return ERROR;
+    }
+
+    // Path costs are ints too, and with costs every cell can add MAX_COST
+    struct dial d = { .costs = maze_costs(m) };
+    size_t n_cells = maze_cells(m);
+    if (d.costs && n_cells > INT_MAX / MAX_COST) {
+        debug_print("Maze too large for dijkstra_solve");
+        return ERROR;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    int index_destination = maze_index(m, r_dest, c_dest);
+
+    d.bq = bucket_queue_init(N_BUCKETS);
+    d.p = parent_map_init(n_cells);
+    if (d.costs) {
+        d.g = malloc(n_cells * sizeof(int));
+    }
+    if (d.bq == NULL || d.p == NULL || (d.costs && d.g == NULL)) {
+        debug_print("Could not initialize dijkstra_solve");
+        free(d.g);
+        parent_map_cleanup(d.p);
+        bucket_queue_cleanup(d.bq);
+        return ERROR;
+    }
+    for (size_t i = 0; d.g && i < n_cells; i++) {
+        d.g[i] = INT_MAX;
+    }
+
+    // Walk the raw cells when the maze allows it, see maze_data()
+    char *cells = maze_data(m);
+    int deltas[N_MOVES];
+    maze_index_deltas(m, deltas);
+
+    int result = NOT_FOUND;
+    if (d.g) {
+        d.g[index_start] = 0;
+    } else {
+        maze_set(m, r_start, c_start, VISITED);
+    }
+    if (bucket_queue_push(d.bq, 0, index_start) == 1) {
+        debug_print("Could not push element onto bucket queue in "
+                    "dijkstra_solve");
+        result = ERROR;
+    }
+
+    while (result == NOT_FOUND && !bucket_queue_empty(d.bq)) {
+        int g_i;
+        int i = bucket_queue_pop(d.bq, &g_i);
+        if (d.g) {
+            if (g_i > d.g[i]) {
+                continue;
+            }
+            if (cells) {
+                cells[i] = VISITED;
+            } else {
+                maze_set(m, maze_row(m, i), maze_col(m, i), VISITED);
+            }
+        }
+
+        if (i == index_destination) {
+            *length = parent_map_trace(d.p, m, index_start, index_destination);
+            result = g_i;
+            break;
+        }
+
+        int err = cells ? expand_cells(&d, cells, deltas, i, g_i)
+                        : expand_maze(&d, m, i, g_i);
+        if (err == ERROR) {
+            debug_print("Could not expand cell in dijkstra_solve");
+            result = ERROR;
+        }
+    }
+
+    if (print_stats) {
+        bucket_queue_stats(d.bq);
+    }
+    free(d.g);
+    parent_map_cleanup(d.p);
+    bucket_queue_cleanup(d.bq);
+    return result;
+}
+
+/* Runs dijkstra_solve() and keeps the cost of the path for print_cost().
+ * Returns the length of the path, NOT_FOUND or ERROR. */
+static int solve(struct maze *m, bool print_stats) {
+    int path_length = 0;
+    path_cost = dijkstra_solve(m, &path_length, print_stats);
+    return path_cost < 0 ? path_cost : path_length;
+}
+
+static void print_cost(FILE *fp) {
+    fprintf(fp, " and cost: %d", path_cost);
+}
+
+int main(int argc, char *argv[]) {
+    /* see driver.h for the options */
+    struct driver d = {
+        .name = "dijkstra",
+        .solve = solve,
+        .print_found = print_cost,
+    };
+    return driver_main(&d, argc, argv);
+}
@@ -0,0 +1,165 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "bucket_queue.h"
+#include "driver.h"
+#include "junction_graph.h"
+#include "maze.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+// The junction graph of the maze, built by setup()
+static struct junction_graph *graph = NULL;
+
+/* Marks the path from node 'start' to node 'dest' in maze 'm', following the
+ * 'parent' nodes and 'parent_edge' edges back from 'dest'. Like
+ * parent_map_trace() the start is marked and the destination is not. */
+static void mark_path(const struct junction_graph *g, struct maze *m,
+                      const int *parent, const size_t *parent_edge,
+                      int start, int dest) {
+    for (int v = dest; v != start; v = parent[v]) {
+        int u = parent[v];
+        junction_graph_mark_edge(g, m, u, parent_edge[v]);
+        int cell = junction_graph_cell(g, u);
+        maze_set(m, maze_row(m, cell), maze_col(m, cell), PATH);
+    }
+}
+
+/* Solves the maze m with Dijkstra's algorithm over its junction graph 'g',
+ * with a bucket queue as the edge weights are small integers. Only the nodes
+ * of 'g' are searched, the corridors of the path found are expanded back into
+ * PATH cells of 'm'. With 'print_stats' the open list statistics are
+ * printed to stderr.
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int graph_solve(struct maze *m, const struct junction_graph *g,
+                bool print_stats) {
+    if (m == NULL || g == NULL) {
+        debug_print("Pointer to maze or graph is NULL in graph_solve");
+        return ERROR;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+
+    int start = junction_graph_node(g, maze_index(m, r_start, c_start));
+    int dest = junction_graph_node(g, maze_index(m, r_dest, c_dest));
+    if (start == -1 || dest == -1) {
+        // The start or the destination is a wall
+        return NOT_FOUND;
+    }
+
+    // Keys in the queue are never more than one edge apart
+    size_t n_nodes = (size_t) junction_graph_nodes(g);
+    struct bucket_queue *bq =
+        bucket_queue_init((size_t) junction_graph_max_weight(g) + 1);
+    int *dist = malloc(n_nodes * sizeof(int));
+    int *parent = malloc(n_nodes * sizeof(int));
+    size_t *parent_edge = malloc(n_nodes * sizeof(size_t));
+    if (bq == NULL || dist == NULL || parent == NULL || parent_edge == NULL) {
+        debug_print("Could not initialize graph_solve");
+        free(parent_edge);
+        free(parent);
+        free(dist);
+        bucket_queue_cleanup(bq);
+        return ERROR;
+    }
+    for (size_t v = 0; v < n_nodes; v++) {
+        dist[v] = INT_MAX;
+    }
+
+    int result = NOT_FOUND;
+    dist[start] = 0;
+    if (bucket_queue_push(bq, 0, start) == 1) {
+        debug_print("Could not push element onto bucket queue in graph_solve");
+        result = ERROR;
+    }
+
+    while (result == NOT_FOUND && !bucket_queue_empty(bq)) {
+        int key;
+        int u = bucket_queue_pop(bq, &key);
+        if (key > dist[u]) {
+            // A shorter path to 'u' was found after this entry was pushed
+            continue;
+        }
+
+        if (u == dest) {
+            mark_path(g, m, parent, parent_edge, start, dest);
+            result = dist[dest];
+            break;
+        }
+
+        size_t end = junction_graph_first_edge(g, u + 1);
+        for (size_t e = junction_graph_first_edge(g, u); e < end; e++) {
+            int v = junction_graph_target(g, e);
+            int new_dist = dist[u] + junction_graph_weight(g, e);
+            if (new_dist >= dist[v]) {
+                continue;
+            }
+            dist[v] = new_dist;
+            parent[v] = u;
+            parent_edge[v] = e;
+            if (bucket_queue_push(bq, new_dist, v) == 1) {
+                debug_print("Could not push to bucket queue in graph_solve");
+                result = ERROR;
+                break;
+            }
+        }
+    }
+
+    if (print_stats) {
+        bucket_queue_stats(bq);
+    }
+    free(parent_edge);
+    free(parent);
+    free(dist);
+    bucket_queue_cleanup(bq);
+    return result;
+}
+
+/* Builds the junction graph of 'm' before the search is timed. */
+static int setup(struct maze *m, const char *maze_file, bool print_stats) {
+    (void) maze_file;
+    graph = junction_graph_init(m);
+    if (!graph) {
+        fprintf(stderr, "Error building junction graph\n");
+        return 1;
+    }
+    if (print_stats) {
+        fprintf(stderr, "graph %d %zu\n", junction_graph_nodes(graph),
+                junction_graph_edges(graph));
+    }
+    return 0;
+}
+
+/* Runs graph_solve() on the junction graph of setup(). */
+static int solve(struct maze *m, bool print_stats) {
+    return graph_solve(m, graph, print_stats);
+}
+
+static void cleanup(void) {
+    junction_graph_cleanup(graph);
+}
+
+int main(int argc, char *argv[]) {
+    /* -s also prints the graph statistics, see driver.h for the options */
+    struct driver d = {
+        .name = "graph",
+        .solve = solve,
+        .setup = setup,
+        .cleanup = cleanup,
+    };
+    return driver_main(&d, argc, argv);
+}
@@ -0,0 +1,363 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "bucket_queue.h"
+#include "driver.h"
+#include "maze.h"
+#include "parent_map.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* Moves in m_offsets are up, right, down, left. */
+#define MOVE_UP 0
+#define MOVE_RIGHT 1
+#define MOVE_DOWN 2
+#define MOVE_LEFT 3
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Returns the Manhattan distance from (r, c) to (r_dest, c_dest). */
+static int manhattan(int r, int c, int r_dest, int c_dest) {
+    return abs(r - r_dest) + abs(c - c_dest);
+}
+
+/* The tiles of a maze as row bitmaps, bit c % 64 of word c / 64 of a row is
+ * column c, laid out as by maze_wall_row(). 'blocked' has the tiles that can
+ * not be entered: walls, the border and the bits after the last column.
+ * 'stop_right' and 'stop_left' add the tiles where a horizontal run in that
+ * direction is a jump point, so a run is a scan for the next set bit a word
+ * at a time instead of a check of every tile. */
+struct jump_map {
+    int rows;
+    int cols;
+    size_t words;
+    uint64_t *blocked;
+    uint64_t *stop_right;
+    uint64_t *stop_left;
+};
+
+static void jump_map_cleanup(struct jump_map *j) {
+    free(j->blocked);
+    free(j->stop_right);
+    free(j->stop_left);
+}
+
+/* Returns the words of row 'r' of the bitmap 'bits' of 'j'. */
+static const uint64_t *row_of(const struct jump_map *j, const uint64_t *bits,
+                              int r) {
+    return bits + (size_t) r * j->words;
+}
+
+/* Returns true if bit 'c' is set in the row 'row'. */
+static bool bit_test(const uint64_t *row, int c) {
+    return (row[c / 64] >> (c % 64)) & 1;
+}
+
+/* Returns true if (r, c) is inside the maze and not a wall. */
+static bool walkable(const struct jump_map *j, int r, int c) {
+    return r >= 0 && r < j->rows && c >= 0 && c < j->cols
+           && !bit_test(row_of(j, j->blocked, r), c);
+}
+
+/* Fills in the bitmaps of 'j' for the maze 'm', a row at a time from
+ * maze_wall_row(). A tile is a jump point of a run to the right if it is
+ * open and has an open tile above or below it whose left neighbour is
+ * blocked, the forced neighbours of jump_horizontal(), and the same to the
+ * left. Returns 0 if successful, 1 otherwise. */
+static int jump_map_init(struct jump_map *j, const struct maze *m) {
+    j->rows = maze_rows(m);
+    j->cols = maze_cols(m);
+    j->words = ((size_t) j->cols + 63) / 64;
+    size_t n_words = (size_t) j->rows * j->words;
+    j->blocked = malloc(n_words * sizeof(uint64_t));
+    j->stop_right = malloc(n_words * sizeof(uint64_t));
+    j->stop_left = malloc(n_words * sizeof(uint64_t));
+    if (!j->blocked || !j->stop_right || !j->stop_left) {
+        jump_map_cleanup(j);
+        return 1;
+    }
+
+    // The border can not be entered, see maze_valid_move()
+    int last = j->cols - 1;
+    for (int r = 0; r < j->rows; r++) {
+        uint64_t *row = j->blocked + (size_t) r * j->words;
+        maze_wall_row(m, r, row);
+        if (r == 0 || r == j->rows - 1) {
+            for (size_t w = 0; w < j->words; w++) {
+                row[w] = ~UINT64_C(0);
+            }
+        }
+        row[0] |= UINT64_C(1);
+        row[(size_t) last / 64] |= UINT64_C(1) << (last % 64);
+    }
+
+    for (int r = 0; r < j->rows; r++) {
+        const uint64_t *row = row_of(j, j->blocked, r);
+        const uint64_t *above = row_of(j, j->blocked, r > 0 ? r - 1 : r);
+        const uint64_t *below = row_of(j, j->blocked,
+                                       r < j->rows - 1 ? r + 1 : r);
+        uint64_t *right = j->stop_right + (size_t) r * j->words;
+        uint64_t *left = j->stop_left + (size_t) r * j->words;
+        for (size_t w = 0; w < j->words; w++) {
+            // Bit c of the shifted rows is column c - 1 and column c + 1
+            uint64_t above_prev = above[w] << 1
+                                  | (w > 0 ? above[w - 1] >> 63 : 1);
+            uint64_t below_prev = below[w] << 1
+                                  | (w > 0 ? below[w - 1] >> 63 : 1);
+            uint64_t above_next = above[w] >> 1
+                                  | (w + 1 < j->words ? above[w + 1] << 63
+                                                      : UINT64_C(1) << 63);
+            uint64_t below_next = below[w] >> 1
+                                  | (w + 1 < j->words ? below[w + 1] << 63
+                                                      : UINT64_C(1) << 63);
+            uint64_t open = ~row[w];
+            right[w] = row[w] | (open & ((~above[w] & above_prev)
+                                         | (~below[w] & below_prev)));
+            left[w] = row[w] | (open & ((~above[w] & above_next)
+                                        | (~below[w] & below_next)));
+        }
+    }
+    return 0;
+}
+
+/* Returns the first column after 'c' in direction 'dc' whose bit is set in
+ * 'row', which has 'words' words. There always is one, the border is set in
+ * every bitmap that is scanned. */
+static int next_bit(const uint64_t *row, size_t words, int c, int dc) {
+    int first = c + dc;
+    size_t w = (size_t) first / 64;
+    if (dc > 0) {
+        uint64_t bits = row[w] & (~UINT64_C(0) << (first % 64));
+        while (bits == 0 && ++w < words) {
+            bits = row[w];
+        }
+        return (int) w * 64 + __builtin_ctzll(bits);
+    }
+    uint64_t bits = row[w] & (~UINT64_C(0) >> (63 - first % 64));
+    while (bits == 0 && w-- > 0) {
+        bits = row[w];
+    }
+    return (int) w * 64 + 63 - __builtin_clzll(bits);
+}
+
+/* Moves from (r, c) in horizontal direction 'dc' until a jump point is found:
+ * the destination or a tile with a forced neighbour, a tile above or below
+ * it that is open while the one diagonally behind it is a wall.
+ * Returns the index of the jump point or -1 if the run hits a wall first. */
+static int jump_horizontal(const struct maze *m, const struct jump_map *j,
+                           int r, int c, int dc, int r_dest, int c_dest) {
+    if (!walkable(j, r, c + dc)) {
+        return -1;
+    }
+    const uint64_t *stops = row_of(j, dc > 0 ? j->stop_right
+                                             : j->stop_left, r);
+    int stop = next_bit(stops, j->words, c, dc);
+    // The destination ends the run if it comes before the stop
+    if (r == r_dest && (c_dest - c) * dc > 0 && (stop - c_dest) * dc >= 0
+        && walkable(j, r, c_dest)) {
+        return maze_index(m, r, c_dest);
+    }
+    if (!walkable(j, r, stop)) {
+        return -1;
+    }
+    return maze_index(m, r, stop);
+}
+
+/* Moves from (r, c) in vertical direction 'dr' until a jump point is found:
+ * the destination, a tile with a forced neighbour, or a tile from which a
+ * horizontal run reaches a jump point.
+ * Returns the index of the jump point or -1 if the run hits a wall first. */
+static int jump_vertical(const struct maze *m, const struct jump_map *j,
+                         int r, int c, int dr, int r_dest, int c_dest) {
+    while (true) {
+        r += dr;
+        if (!walkable(j, r, c)) {
+            return -1;
+        }
+        if ((r == r_dest && c == c_dest)
+            || (walkable(j, r, c - 1) && !walkable(j, r - dr, c - 1))
+            || (walkable(j, r, c + 1) && !walkable(j, r - dr, c + 1))
+            || jump_horizontal(m, j, r, c, 1, r_dest, c_dest) != -1
+            || jump_horizontal(m, j, r, c, -1, r_dest, c_dest) != -1) {
+            return maze_index(m, r, c);
+        }
+    }
+}
+
+/* Jumps from the tile at 'current_index' in direction 'move' and, if a jump
+ * point is found that is reached with a shorter distance than before, stores
+ * its distance 'g' and the direction of the jump and adds it to the open
+ * list with key g + h.
+ */
+int check_jump(struct maze *m, const struct jump_map *j,
+               struct bucket_queue *bq, struct parent_map *p, int *g,
+               int r_dest, int c_dest, int move, int current_index) {
+    int r = maze_row(m, current_index);
+    int c = maze_col(m, current_index);
+    int jump_index;
+    if (m_offsets[move][0] == 0) {
+        jump_index = jump_horizontal(m, j, r, c, m_offsets[move][1],
+                                     r_dest, c_dest);
+    } else {
+        jump_index = jump_vertical(m, j, r, c, m_offsets[move][0],
+                                   r_dest, c_dest);
+    }
+    if (jump_index == -1) {
+        return 0;
+    }
+
+    int jump_r = maze_row(m, jump_index);
+    int jump_c = maze_col(m, jump_index);
+    int new_g = g[current_index] + abs(jump_r - r) + abs(jump_c - c);
+    if (maze_get(m, jump_r, jump_c) != VISITED && new_g < g[jump_index]) {
+        g[jump_index] = new_g;
+        parent_map_set(p, jump_index, move);
+
+        int key = new_g + manhattan(jump_r, jump_c, r_dest, c_dest);
+        if (bucket_queue_push(bq, key, jump_index) == 1) {
+            debug_print("Could not push to bucket queue in check_jump");
+            return ERROR;
+        }
+    }
+
+    return 0;
+}
+
+/* Walks back from the destination to the start along the jumps and marks
+ * every tile on the way, except the destination, as PATH. A jump only
+ * records its direction, so the walk goes back tile by tile until it reaches
+ * an expanded tile whose distance plus the steps taken equals the distance
+ * of the tile the jump ended on. That is the tile the jump came from, or
+ * another expanded tile on the same straight line that is just as close to
+ * the start.
+ * Returns the length of the path. */
+static int trace_jumps(const struct parent_map *p, struct maze *m,
+                       const int *g, int index_start, int index_destination) {
+    int i = index_destination;
+    while (i != index_start) {
+        int move = parent_map_get(p, i);
+        int jump_g = g[i];
+        int steps = 0;
+        do {
+            i = maze_index(m, maze_row(m, i) - m_offsets[move][0],
+                           maze_col(m, i) - m_offsets[move][1]);
+            steps++;
+        } while (i != index_start
+                 && !(maze_get(m, maze_row(m, i), maze_col(m, i)) == VISITED
+                      && g[i] + steps == jump_g));
+        // Fill in the tiles the jump skipped, back to the jump's origin
+        int k = i;
+        for (int s = 0; s < steps; s++) {
+            maze_set(m, maze_row(m, k), maze_col(m, k), PATH);
+            k = maze_index(m, maze_row(m, k) + m_offsets[move][0],
+                           maze_col(m, k) + m_offsets[move][1]);
+        }
+    }
+
+    return g[index_destination];
+}
+
+/* Solves the maze m with A* over jump points: only tiles where a shortest
+ * path may have to turn are pushed on the open list, straight runs between
+ * them are skipped. The start is expanded in all four directions, every
+ * other jump point in its jump direction and the two perpendicular ones.
+ * Expanded jump points are marked VISITED.
+ * With 'print_stats' the open list statistics are printed to stderr.
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int jps_solve(struct maze *m, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in jps_solve");
+        return ERROR;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    int index_destination = maze_index(m, r_dest, c_dest);
+
+    // A jump of length L raises f by at most 2L, and L is less than the
+    // number of rows or columns.
+    size_t n_cells = maze_cells(m);
+    int longest = maze_rows(m) > maze_cols(m) ? maze_rows(m) : maze_cols(m);
+    struct bucket_queue *bq = bucket_queue_init(2 * (size_t) longest);
+    struct parent_map *p = parent_map_init(n_cells);
+    int *g = malloc(n_cells * sizeof(int));
+    struct jump_map j = {0};
+    if (bq == NULL || p == NULL || g == NULL || jump_map_init(&j, m)) {
+        debug_print("Could not initialize jps_solve");
+        free(g);
+        parent_map_cleanup(p);
+        bucket_queue_cleanup(bq);
+        return ERROR;
+    }
+    for (size_t i = 0; i < n_cells; i++) {
+        g[i] = INT_MAX;
+    }
+
+    int result = NOT_FOUND;
+    g[index_start] = 0;
+    if (bucket_queue_push(bq, manhattan(r_start, c_start, r_dest, c_dest),
+                          index_start) == 1) {
+        debug_print("Could not push element onto bucket queue in jps_solve");
+        result = ERROR;
+    }
+
+    while (result == NOT_FOUND && !bucket_queue_empty(bq)) {
+        int i = bucket_queue_pop(bq, NULL);
+        int r = maze_row(m, i);
+        int c = maze_col(m, i);
+        if (maze_get(m, r, c) == VISITED) {
+            continue;
+        }
+        maze_set(m, r, c, VISITED);
+
+        if (i == index_destination) {
+            result = trace_jumps(p, m, g, index_start, index_destination);
+            break;
+        }
+
+        // Never jump back the way we came
+        int back = i == index_start ? -1
+                                    : (parent_map_get(p, i) + 2) % N_MOVES;
+        for (int move = 0; move < N_MOVES; move++) {
+            if (move != back
+                && check_jump(m, &j, bq, p, g, r_dest, c_dest, move,
+                              i) == ERROR) {
+                debug_print("Could not check jump in jps_solve");
+                result = ERROR;
+                break;
+            }
+        }
+    }
+
+    if (print_stats) {
+        bucket_queue_stats(bq);
+    }
+    jump_map_cleanup(&j);
+    free(g);
+    parent_map_cleanup(p);
+    bucket_queue_cleanup(bq);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    /* see driver.h for the options */
+    struct driver d = {
+        .name = "jps",
+        .solve = jps_solve,
+    };
+    return driver_main(&d, argc, argv);
+}
@@ -0,0 +1,157 @@
+// Needed for getline()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "driver.h"
+#include "lpa_star.h"
+#include "maze.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+// The planner of the maze, made by setup()
+static struct lpa_star *planner = NULL;
+
+// The wall toggles to replan after (-w)
+static const char *toggle_file = NULL;
+
+/* Reads the cells of one batch of toggles from 'line', pairs of a row and a
+ * column, into the arrays pointed to by 'rows' and 'cols', which are grown
+ * as needed and have room for '*capacity' cells.
+ * Returns the number of cells or -1 if an error occured. */
+static long read_batch(const char *line, int **rows, int **cols,
+                       size_t *capacity) {
+    size_t n = 0;
+    int r, c, consumed;
+    while (sscanf(line, "%d %d%n", &r, &c, &consumed) == 2) {
+        if (n == *capacity) {
+            size_t new_capacity = *capacity ? 2 * *capacity : 64;
+            int *new_rows = realloc(*rows, new_capacity * sizeof(int));
+            if (!new_rows) {
+                return -1;
+            }
+            *rows = new_rows;
+            int *new_cols = realloc(*cols, new_capacity * sizeof(int));
+            if (!new_cols) {
+                return -1;
+            }
+            *cols = new_cols;
+            *capacity = new_capacity;
+        }
+        (*rows)[n] = r;
+        (*cols)[n] = c;
+        n++;
+        line += consumed;
+    }
+    return (long) n;
+}
+
+/* Runs lpa_star_solve() on the planner of setup() and prints its open list
+ * statistics with 'print_stats'.
+ * Returns the length of the path, NOT_FOUND or ERROR. */
+static int search(bool print_stats) {
+    int path_length = lpa_star_solve(planner);
+    if (print_stats) {
+        lpa_star_stats(planner);
+    }
+    return path_length;
+}
+
+/* Prints the path length, then applies every line of 'fp' as one batch of
+ * wall toggles and prints the new path length after each batch, or
+ * NOT_FOUND if there is no path.
+ * Returns 0 if successful, 1 otherwise. */
+static int replan(FILE *fp, bool print_stats) {
+    char *line = NULL;
+    size_t line_size = 0;
+    int *rows = NULL;
+    int *cols = NULL;
+    size_t capacity = 0;
+    int status = 0;
+
+    int path_length = search(print_stats);
+    while (path_length != ERROR) {
+        printf("%d\n", path_length);
+        if (getline(&line, &line_size, fp) == -1) {
+            break;
+        }
+
+        long n = read_batch(line, &rows, &cols, &capacity);
+        if (n == -1
+            || lpa_star_toggle_walls(planner, rows, cols, (size_t) n)) {
+            fprintf(stderr, "Could not toggle walls\n");
+            status = 1;
+            break;
+        }
+        path_length = search(print_stats);
+    }
+    if (path_length == ERROR) {
+        status = 1;
+    }
+
+    free(line);
+    free(rows);
+    free(cols);
+    return status;
+}
+
+/* The batch of -w: replans after every line of the toggle file. */
+static int replan_file(struct maze *m, bool print_stats) {
+    (void) m;
+    FILE *fp = fopen(toggle_file, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot open file %s\n", toggle_file);
+        return 1;
+    }
+    int status = replan(fp, print_stats);
+    fclose(fp);
+    return status;
+}
+
+/* Handles -w, which replans after every batch instead of printing the
+ * maze. */
+static int option(struct driver *d, int opt, const char *arg) {
+    if (opt != 'w') {
+        return 1;
+    }
+    toggle_file = arg;
+    d->run = replan_file;
+    return 0;
+}
+
+static int setup(struct maze *m, const char *maze_file, bool print_stats) {
+    (void) maze_file;
+    (void) print_stats;
+    planner = lpa_star_init(m);
+    return planner == NULL;
+}
+
+/* Searches once and marks the path found in the maze. */
+static int solve(struct maze *m, bool print_stats) {
+    (void) m;
+    int path_length = search(print_stats);
+    lpa_star_mark_path(planner);
+    return path_length;
+}
+
+static void cleanup(void) {
+    lpa_star_cleanup(planner);
+}
+
+int main(int argc, char *argv[]) {
+    /* -w replans after every line of wall toggles in the given file,
+     * see driver.h for the other options */
+    struct driver d = {
+        .name = "lpa",
+        .solve = solve,
+        .options = "w:",
+        .usage = "[-w toggles] ",
+        .option = option,
+        .setup = setup,
+        .cleanup = cleanup,
+    };
+    return driver_main(&d, argc, argv);
+}
@@ -0,0 +1,866 @@
+// Needed for getopt(), mkdtemp(), pread() and pwrite()
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "driver.h"
+#include "index_heap.h"
+#include "maze.h"
+#include "path.h"
+#include "tile_cache.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+
+/* The maze is split in square tiles of TILE x TILE cells. A tile is one
+ * record of the tile file: its walls as a bitmap, TILE / 64 words per row,
+ * followed by the distance of every cell plus one, 0 if it is not reached.
+ * With TILE 512 a record is 1 MB of distances and 32 kB of walls. */
+#define TILE_BITS 9
+#define TILE (1 << TILE_BITS)
+#define TILE_MASK (TILE - 1)
+#define TILE_CELLS ((size_t) TILE * TILE)
+#define ROW_WORDS (TILE / 64)
+#define WALL_BYTES (TILE_CELLS / 8)
+#define RECORD_SIZE (WALL_BYTES + TILE_CELLS * sizeof(uint32_t))
+
+/* Seeds kept in memory for one tile before they are appended to its seed
+ * file. */
+#define SEED_BUFFER 512
+
+/* Default memory budget in MB (-m). */
+#define DEFAULT_MEMORY 256
+
+/* Marks the cells on a shortest path in their distance, see mark_paths().
+ * The distances stay below it. */
+#define DIST_MARK (UINT32_C(1) << 31)
+
+/* Longest name of the scratch directory, the file names in it are short. */
+#define SCRATCH_DIR_MAX (PATH_MAX - 64)
+
+#define USAGE "usage: %s [-m megabytes] [-d dir] [-o path_file] [-s] " \
+              "maze_file\n"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+// Print the search statistics to stderr after solving (-s)
+static bool print_stats = false;
+
+/* A cell of a tile, by its index in the tile, that is reached with 'dist'
+ * moves from the start. */
+struct seed {
+    uint32_t cell;
+    uint32_t dist;
+};
+
+/* The seeds of a tile that are still in memory, up to SEED_BUFFER. */
+struct seed_buffer {
+    struct seed *data;
+    size_t size;
+};
+
+/* State of one out-of-core search.
+ *
+ * The tiles live in the file 'fd' in the scratch directory 'dir' and are
+ * worked on through 'cache'. A tile is run from its seeds, cells of the tile
+ * with a distance, with a breadth first search that stays in the tile. A
+ * move out of the tile becomes a seed of the neighbouring tile, which is
+ * kept in 'buffers' and appended to the seed file of that tile when the
+ * buffer is full. 'pending' is the lowest distance of the seeds of every
+ * tile and 'heap' holds the tiles with seeds by that distance, so tiles run
+ * roughly in the order of a global breadth first search. A seed that lowers
+ * the distance of a cell that was reached before starts the search again
+ * from that cell, so the distances are exact when every tile that is left
+ * only has seeds at least as far away as the destination.
+ * 'best' is the distance of the destination, UINT32_MAX until it is
+ * reached. */
+struct ooc {
+    int rows;
+    int cols;
+    int tile_cols;
+    size_t n_tiles;
+    int r_start, c_start;
+    int r_finish, c_finish;
+
+    char dir[SCRATCH_DIR_MAX];
+    int fd;
+    struct tile_cache *cache;
+
+    uint32_t *queue;
+    struct seed *seeds;
+    size_t seeds_capacity;
+    struct seed_buffer *buffers;
+    size_t n_buffers;
+    size_t max_buffers;
+    bool *spilled;
+    uint32_t *pending;
+    struct index_heap *heap;
+    uint32_t best;
+
+    long num_of_pushes;
+    long num_of_pops;
+    size_t max_elements;
+};
+
+/* Returns the tile of the cell (r, c). */
+static size_t tile_of(const struct ooc *o, int r, int c) {
+    return (size_t) (r >> TILE_BITS) * (size_t) o->tile_cols
+           + (size_t) (c >> TILE_BITS);
+}
+
+/* Returns the index of the cell (r, c) in its tile. */
+static uint32_t cell_of(int r, int c) {
+    return (uint32_t) (r & TILE_MASK) << TILE_BITS
+           | (uint32_t) (c & TILE_MASK);
+}
+
+static bool wall_test(const uint64_t *walls, uint32_t i) {
+    return (walls[i / 64] >> (i % 64)) & 1;
+}
+
+static uint32_t *tile_dist(char *record) {
+    return (uint32_t *) (record + WALL_BYTES);
+}
+
+/* Writes the name of the file 'name' in the scratch directory to 'path'. */
+static void scratch_path(const struct ooc *o, char *path, const char *name) {
+    snprintf(path, PATH_MAX, "%s/%s", o->dir, name);
+}
+
+/* Writes the name of the seed file of tile 't' to 'path'. */
+static void seed_path(const struct ooc *o, char *path, size_t t) {
+    snprintf(path, PATH_MAX, "%s/seeds_%zu", o->dir, t);
+}
+
+/* Sets the bits from 'from' to the end of a tile row of walls. */
+static void set_bits_from(uint64_t *row, int from) {
+    for (int w = from / 64; w < ROW_WORDS; w++) {
+        int low = w == from / 64 ? from % 64 : 0;
+        row[w] |= ~UINT64_C(0) << low;
+    }
+}
+
+/* Reads 'size' bytes at 'offset' of 'fd' into 'buf'.
+ * Returns 0 if successful, 1 otherwise. */
+static int read_exact(int fd, void *buf, size_t size, off_t offset) {
+    char *p = buf;
+    while (size > 0) {
+        ssize_t n = pread(fd, p, size, offset);
+        if (n <= 0) {
+            return 1;
+        }
+        p += n;
+        size -= (size_t) n;
+        offset += n;
+    }
+    return 0;
+}
+
+/* The maze file that is split into tiles. A text maze has rows of 'cols'
+ * characters and a newline, 'stride' bytes each. A binary maze has rows of
+ * 'row_words' words, see maze_bin_info(). */
+struct source {
+    int fd;
+    bool text;
+    size_t offset;
+    size_t stride;
+    size_t row_words;
+    int64_t start_index;
+    int64_t finish_index;
+};
+
+/* Opens the maze file 'path' and stores its size in 'o'.
+ * Returns 0 if successful, 1 otherwise. */
+static int open_source(struct ooc *o, struct source *src, const char *path) {
+    struct maze_bin_info info;
+    src->fd = open(path, O_RDONLY);
+    if (src->fd < 0) {
+        return 1;
+    }
+    if (maze_bin_info(path, &info) == 0) {
+        src->text = false;
+        src->offset = info.offset;
+        src->row_words = info.row_words;
+        src->stride = info.row_words * sizeof(uint64_t);
+        src->start_index = info.start_index;
+        src->finish_index = info.finish_index;
+        o->rows = info.rows;
+        o->cols = info.cols;
+        return 0;
+    }
+
+    // A text maze: the first line sets the number of columns
+    struct stat st;
+    if (fstat(src->fd, &st) != 0) {
+        return 1;
+    }
+    size_t len = (size_t) st.st_size;
+    char chunk[4096];
+    size_t cols = 0;
+    char *nl = NULL;
+    while (!nl && cols < len && cols <= INT32_MAX) {
+        size_t n = len - cols < sizeof(chunk) ? len - cols : sizeof(chunk);
+        if (read_exact(src->fd, chunk, n, (off_t) cols)) {
+            return 1;
+        }
+        nl = memchr(chunk, '\n', n);
+        cols += nl ? (size_t) (nl - chunk) : n;
+    }
+    if (!nl || cols == 0 || cols > INT32_MAX || len / (cols + 1) > INT32_MAX) {
+        return 1;
+    }
+
+    // The rows are checked while they are split, the rest must be empty or
+    // start with an empty line
+    size_t rows = len / (cols + 1);
+    size_t end = rows * (cols + 1);
+    char c;
+    if (end < len && (read_exact(src->fd, &c, 1, (off_t) end) || c != '\n')) {
+        return 1;
+    }
+    src->text = true;
+    src->offset = 0;
+    src->stride = cols + 1;
+    src->start_index = -1;
+    src->finish_index = -1;
+    o->rows = (int) rows;
+    o->cols = (int) cols;
+    return 0;
+}
+
+/* Reads the columns of 'n_tiles' tiles from tile column 'tc' on of row 'r'
+ * into 'row' as walls. Rows after the maze are all walls, the columns after
+ * it are left to split_maze(). 'text' is room for the characters of a text
+ * row.
+ * Returns 0 if successful, 1 otherwise. */
+static int read_row(struct source *src, const struct ooc *o, int r, int tc,
+                    int n_tiles, uint64_t *row, char *text) {
+    size_t width = (size_t) n_tiles * ROW_WORDS;
+    memset(row, 0xff, width * sizeof(uint64_t));
+    if (r >= o->rows) {
+        return 0;
+    }
+
+    off_t row_offset = (off_t) (src->offset + (size_t) r * src->stride);
+    if (!src->text) {
+        size_t first = (size_t) tc * ROW_WORDS;
+        size_t n = src->row_words - first < width ? src->row_words - first
+                                                  : width;
+        return read_exact(src->fd, row, n * sizeof(uint64_t),
+                          row_offset + (off_t) (first * sizeof(uint64_t)));
+    }
+
+    // Text rows are translated here, the newline is read with the last
+    // column to check the row
+    size_t first = (size_t) tc * TILE;
+    size_t n = (size_t) o->cols - first;
+    bool last = n <= width * 64;
+    if (!last) {
+        n = width * 64;
+    }
+    if (read_exact(src->fd, text, n + last, row_offset + (off_t) first)
+        || (last && text[n] != '\n')) {
+        return 1;
+    }
+    memset(row, 0, width * sizeof(uint64_t));
+    for (size_t k = 0; k < n; k++) {
+        if (text[k] == WALL) {
+            row[k / 64] |= UINT64_C(1) << (k % 64);
+        } else if (text[k] == START || text[k] == FINISH) {
+            // The last marker wins, like in maze_read()
+            int64_t index = (int64_t) r * o->cols + (int64_t) (first + k);
+            if (text[k] == START) {
+                src->start_index = index;
+            } else {
+                src->finish_index = index;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Splits the maze file into the walls of the tiles in the tile file. The
+ * maze is read one band of TILE rows at a time, as wide as 'budget' bytes
+ * of buffer allow, and every tile of the band is written at once. Both the
+ * reads and the writes run through the files from front to back. The
+ * border of the maze is a wall in the tiles.
+ * Returns 0 if successful, 1 otherwise. */
+static int split_maze(struct ooc *o, struct source *src, size_t budget) {
+    size_t per_tile = TILE * (ROW_WORDS * sizeof(uint64_t) + TILE);
+    int span = (int) (budget / per_tile);
+    if (span < 1) {
+        span = 1;
+    } else if (span > o->tile_cols) {
+        span = o->tile_cols;
+    }
+    size_t width = (size_t) span * ROW_WORDS;
+    uint64_t *band = malloc(TILE * width * sizeof(uint64_t));
+    char *text = malloc((size_t) span * TILE + 1);
+    uint64_t *walls = malloc(WALL_BYTES);
+    int err = !band || !text || !walls;
+
+    int tile_rows = (o->rows + TILE - 1) / TILE;
+    for (int tr = 0; tr < tile_rows && !err; tr++) {
+        for (int tc = 0; tc < o->tile_cols && !err; tc += span) {
+            int n_tiles = o->tile_cols - tc < span ? o->tile_cols - tc : span;
+            for (int lr = 0; lr < TILE && !err; lr++) {
+                err = read_row(src, o, tr * TILE + lr, tc, n_tiles,
+                               band + (size_t) lr * width, text);
+            }
+
+            for (int k = 0; k < n_tiles && !err; k++) {
+                int c0 = (tc + k) * TILE;
+                for (int lr = 0; lr < TILE; lr++) {
+                    int r = tr * TILE + lr;
+                    uint64_t *row = walls + (size_t) lr * ROW_WORDS;
+                    memcpy(row, band + (size_t) lr * width
+                                + (size_t) k * ROW_WORDS,
+                           ROW_WORDS * sizeof(uint64_t));
+                    if (r == 0 || r >= o->rows - 1) {
+                        set_bits_from(row, 0);
+                    }
+                    if (c0 == 0) {
+                        row[0] |= UINT64_C(1);
+                    }
+                    if (o->cols - 1 - c0 < TILE) {
+                        set_bits_from(row, o->cols - 1 - c0);
+                    }
+                }
+                off_t offset = (off_t) (tile_of(o, tr * TILE, c0)
+                                        * RECORD_SIZE);
+                err = pwrite(o->fd, walls, WALL_BYTES, offset)
+                      != (ssize_t) WALL_BYTES;
+            }
+        }
+    }
+
+    free(walls);
+    free(text);
+    free(band);
+    return err;
+}
+
+/* Appends the seeds in the buffer of tile 't' to its seed file and frees
+ * the buffer.
+ * Returns 0 if successful, 1 otherwise. */
+static int spill_seeds(struct ooc *o, size_t t) {
+    struct seed_buffer *b = &o->buffers[t];
+    char path[PATH_MAX];
+    seed_path(o, path, t);
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) {
+        return 1;
+    }
+    size_t bytes = b->size * sizeof(struct seed);
+    int err = write(fd, b->data, bytes) != (ssize_t) bytes;
+    err |= close(fd) != 0;
+
+    o->spilled[t] = true;
+    free(b->data);
+    b->data = NULL;
+    b->size = 0;
+    o->n_buffers--;
+    return err;
+}
+
+/* Adds the seed (r, c) at distance 'dist' to its tile.
+ * Returns 0 if successful, 1 otherwise. */
+static int add_seed(struct ooc *o, int r, int c, uint32_t dist) {
+    size_t t = tile_of(o, r, c);
+    struct seed_buffer *b = &o->buffers[t];
+    if (b->data == NULL) {
+        // Keep the buffers within their share of the memory budget
+        if (o->n_buffers == o->max_buffers) {
+            for (size_t u = 0; u < o->n_tiles; u++) {
+                if (o->buffers[u].data && spill_seeds(o, u)) {
+                    return 1;
+                }
+            }
+        }
+        b->data = malloc(SEED_BUFFER * sizeof(struct seed));
+        if (b->data == NULL) {
+            return 1;
+        }
+        o->n_buffers++;
+    }
+
+    b->data[b->size++] = (struct seed) { cell_of(r, c), dist };
+    o->num_of_pushes++;
+    if (dist < o->pending[t]) {
+        o->pending[t] = dist;
+        if (index_heap_push(o->heap, (int) t, dist)) {
+            return 1;
+        }
+    }
+    return b->size == SEED_BUFFER ? spill_seeds(o, t) : 0;
+}
+
+/* Makes room for 'n' seeds in 'o->seeds'.
+ * Returns 0 if successful, 1 otherwise. */
+static int reserve_seeds(struct ooc *o, size_t n) {
+    if (n <= o->seeds_capacity) {
+        return 0;
+    }
+    struct seed *seeds = realloc(o->seeds, n * sizeof(struct seed));
+    if (seeds == NULL) {
+        return 1;
+    }
+    o->seeds = seeds;
+    o->seeds_capacity = n;
+    return 0;
+}
+
+/* Moves all seeds of tile 't', from its seed file and its buffer, to
+ * 'o->seeds' and stores their number in 'n'.
+ * Returns 0 if successful, 1 otherwise. */
+static int take_seeds(struct ooc *o, size_t t, size_t *n) {
+    *n = 0;
+    if (o->spilled[t]) {
+        char path[PATH_MAX];
+        seed_path(o, path, t);
+        int fd = open(path, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            return 1;
+        }
+        *n = (size_t) st.st_size / sizeof(struct seed);
+        int err = reserve_seeds(o, *n)
+                  || read_exact(fd, o->seeds, *n * sizeof(struct seed), 0);
+        close(fd);
+        if (err || unlink(path) != 0) {
+            return 1;
+        }
+        o->spilled[t] = false;
+    }
+
+    struct seed_buffer *b = &o->buffers[t];
+    if (b->data) {
+        if (reserve_seeds(o, *n + b->size)) {
+            return 1;
+        }
+        memcpy(o->seeds + *n, b->data, b->size * sizeof(struct seed));
+        *n += b->size;
+        free(b->data);
+        b->data = NULL;
+        b->size = 0;
+        o->n_buffers--;
+    }
+    return 0;
+}
+
+/* Orders seeds by distance. */
+static int seed_compare(const void *a, const void *b) {
+    uint32_t da = ((const struct seed *) a)->dist;
+    uint32_t db = ((const struct seed *) b)->dist;
+    return (da > db) - (da < db);
+}
+
+/* Runs tile 't' from its seeds: a breadth first search in the tile, where
+ * the seeds join the queue when its distance reaches theirs. Cells only
+ * get a distance if it is lower than the one they have, moves out of the
+ * tile become seeds of the neighbouring tiles.
+ * Returns 0 if successful, 1 otherwise. */
+static int run_tile(struct ooc *o, size_t t) {
+    size_t n_seeds;
+    if (take_seeds(o, t, &n_seeds)) {
+        return 1;
+    }
+    qsort(o->seeds, n_seeds, sizeof(struct seed), seed_compare);
+
+    char *record = tile_cache_get(o->cache, t, true);
+    if (record == NULL) {
+        return 1;
+    }
+    const uint64_t *walls = (const uint64_t *) record;
+    uint32_t *dist = tile_dist(record);
+    int r0 = (int) (t / (size_t) o->tile_cols) * TILE;
+    int c0 = (int) (t % (size_t) o->tile_cols) * TILE;
+
+    size_t head = 0, tail = 0, k = 0;
+    while (k < n_seeds || head < tail) {
+        uint32_t i, d;
+        if (head < tail && (k == n_seeds || dist[o->queue[head]] - 1
+                                            <= o->seeds[k].dist)) {
+            i = o->queue[head++];
+            d = dist[i] - 1;
+        } else {
+            i = o->seeds[k].cell;
+            d = o->seeds[k].dist;
+            k++;
+            if (wall_test(walls, i) || (dist[i] != 0 && dist[i] - 1 <= d)) {
+                continue;
+            }
+            dist[i] = d + 1;
+        }
+        if (d >= o->best) {
+            continue;
+        }
+        o->num_of_pops++;
+
+        int r = r0 + (int) (i >> TILE_BITS);
+        int c = c0 + (int) (i & TILE_MASK);
+        if (r == o->r_finish && c == o->c_finish) {
+            o->best = d;
+        }
+        if (d + 1 >= o->best) {
+            continue;
+        }
+        if (d + 2 >= DIST_MARK) {
+            debug_print("Distance too large in run_tile");
+            return 1;
+        }
+
+        for (int move = 0; move < N_MOVES; move++) {
+            int new_r = r + m_offsets[move][0];
+            int new_c = c + m_offsets[move][1];
+            if (new_r >> TILE_BITS != r >> TILE_BITS
+                || new_c >> TILE_BITS != c >> TILE_BITS) {
+                // The border is a wall, so a move out of the tile stays in
+                // the maze
+                if (add_seed(o, new_r, new_c, d + 1)) {
+                    return 1;
+                }
+                continue;
+            }
+            uint32_t j = cell_of(new_r, new_c);
+            if (!wall_test(walls, j) && (dist[j] == 0 || dist[j] > d + 2)) {
+                dist[j] = d + 2;
+                o->queue[tail++] = j;
+                o->num_of_pushes++;
+            }
+        }
+        if (tail - head > o->max_elements) {
+            o->max_elements = tail - head;
+        }
+    }
+    return 0;
+}
+
+/* Returns a pointer to the distance plus one of (r, c), which stays valid
+ * until the next call, or NULL if its tile could not be read. With 'write'
+ * the tile is written back when it is evicted. */
+static uint32_t *dist_ref(struct ooc *o, int r, int c, bool write) {
+    char *record = tile_cache_get(o->cache, tile_of(o, r, c), write);
+    if (record == NULL) {
+        return NULL;
+    }
+    return tile_dist(record) + cell_of(r, c);
+}
+
+/* Marks the destination and every cell one move closer to the start than a
+ * marked cell, with DIST_MARK in its distance: the cells on the shortest
+ * paths. The cells of one distance are kept in a scratch file while the
+ * cells of the next are marked, they do not have to fit in memory.
+ * Returns 0 if successful, 1 otherwise. */
+static int mark_paths(struct ooc *o) {
+    char paths[2][PATH_MAX];
+    scratch_path(o, paths[0], "level_0");
+    scratch_path(o, paths[1], "level_1");
+
+    uint32_t *mark = dist_ref(o, o->r_finish, o->c_finish, true);
+    int cell[2] = { o->r_finish, o->c_finish };
+    FILE *cur = fopen(paths[o->best & 1], "w+b");
+    int err = mark == NULL || cur == NULL || fwrite(cell, sizeof(int), 2, cur)
+                                             != 2;
+    if (!err) {
+        *mark |= DIST_MARK;
+    }
+    for (uint32_t d = o->best; d > 0 && !err; d--) {
+        FILE *next = fopen(paths[(d - 1) & 1], "w+b");
+        err = next == NULL;
+        rewind(cur);
+        while (!err && fread(cell, sizeof(int), 2, cur) == 2) {
+            // The border is a wall, so the neighbours stay in the maze
+            for (int move = 0; move < N_MOVES && !err; move++) {
+                int prev[2] = { cell[0] - m_offsets[move][0],
+                                cell[1] - m_offsets[move][1] };
+                mark = dist_ref(o, prev[0], prev[1], true);
+                err = mark == NULL;
+                if (!err && *mark == d) {
+                    *mark |= DIST_MARK;
+                    err = fwrite(prev, sizeof(int), 2, next) != 2;
+                }
+            }
+        }
+        err |= ferror(cur);
+        fclose(cur);
+        cur = next;
+    }
+
+    if (cur) {
+        fclose(cur);
+    }
+    unlink(paths[0]);
+    unlink(paths[1]);
+    return err;
+}
+
+/* Writes the path to 'out' as runs of moves, see path_write(), from the start
+ * to the destination. Of the marked cells one move further, see
+ * mark_paths(), the path takes the first in the order of m_offsets, which is
+ * the path that bfs_solve() finds: its queue reaches every cell first from
+ * the neighbour with the lowest such moves from the start.
+ * Returns 0 if successful, 1 otherwise. */
+static int write_path(struct ooc *o, FILE *out) {
+    if (mark_paths(o)) {
+        return 1;
+    }
+
+    struct path *p = path_init();
+    if (p == NULL) {
+        return 1;
+    }
+    int r = o->r_start, c = o->c_start;
+    path_clear(p, (int64_t) r * o->cols + c);
+    int err = 0;
+    for (uint32_t d = 1; d <= o->best; d++) {
+        int move = 0;
+        for (; move < N_MOVES; move++) {
+            uint32_t *next = dist_ref(o, r + m_offsets[move][0],
+                                      c + m_offsets[move][1], false);
+            if (next == NULL || *next == ((d + 1) | DIST_MARK)) {
+                err = next == NULL;
+                break;
+            }
+        }
+        if (err || move == N_MOVES || path_append(p, move)) {
+            err = 1;
+            break;
+        }
+        r += m_offsets[move][0];
+        c += m_offsets[move][1];
+    }
+    err = err || path_write(p, out);
+    path_cleanup(p);
+    return err;
+}
+
+/* Frees everything of 'o' and removes the scratch directory. */
+static void cleanup(struct ooc *o) {
+    char path[PATH_MAX];
+    for (size_t t = 0; o->buffers && t < o->n_tiles; t++) {
+        free(o->buffers[t].data);
+        if (o->spilled && o->spilled[t]) {
+            seed_path(o, path, t);
+            unlink(path);
+        }
+    }
+    if (o->cache) {
+        tile_cache_cleanup(o->cache);
+    }
+    if (o->heap) {
+        index_heap_cleanup(o->heap);
+    }
+    if (o->fd >= 0) {
+        close(o->fd);
+        scratch_path(o, path, "tiles");
+        unlink(path);
+    }
+    if (o->dir[0]) {
+        rmdir(o->dir);
+    }
+    free(o->queue);
+    free(o->seeds);
+    free(o->buffers);
+    free(o->spilled);
+    free(o->pending);
+}
+
+/* Sets up the scratch directory in 'dir', splits the maze file 'path' into
+ * tiles and sizes the tile cache and the seed buffers to 'budget' bytes.
+ * Returns 0 if successful, 1 otherwise. */
+static int setup(struct ooc *o, const char *path, const char *dir,
+                 size_t budget) {
+    struct source src = { .fd = -1 };
+    int err = open_source(o, &src, path);
+    if (err || o->rows < 3 || o->cols < 3) {
+        fprintf(stderr, "Cannot read maze file %s\n", path);
+        if (src.fd >= 0) {
+            close(src.fd);
+        }
+        return 1;
+    }
+
+    int len = snprintf(o->dir, sizeof(o->dir), "%s/maze_ooc.XXXXXX", dir);
+    if (len < 0 || (size_t) len >= sizeof(o->dir) || mkdtemp(o->dir) == NULL) {
+        fprintf(stderr, "Cannot create a directory in %s\n", dir);
+        o->dir[0] = '\0';
+        close(src.fd);
+        return 1;
+    }
+    char tiles[PATH_MAX];
+    scratch_path(o, tiles, "tiles");
+    o->fd = open(tiles, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    o->tile_cols = (o->cols + TILE - 1) / TILE;
+    o->n_tiles = (size_t) ((o->rows + TILE - 1) / TILE)
+                 * (size_t) o->tile_cols;
+    err = o->fd < 0 || o->n_tiles > INT_MAX
+          || split_maze(o, &src, budget / 2);
+    close(src.fd);
+    if (err) {
+        fprintf(stderr, "Cannot split the maze into tiles\n");
+        return 1;
+    }
+
+    // Markers in a text maze, otherwise the defaults of maze_init()
+    int64_t start = src.start_index >= 0 ? src.start_index : o->cols + 1;
+    int64_t finish = src.finish_index >= 0
+                     ? src.finish_index
+                     : (int64_t) (o->rows - 2) * o->cols + o->cols - 2;
+    o->r_start = (int) (start / o->cols);
+    o->c_start = (int) (start % o->cols);
+    o->r_finish = (int) (finish / o->cols);
+    o->c_finish = (int) (finish % o->cols);
+
+    // An eighth of the budget for seed buffers, the rest for whole tiles
+    size_t fixed = TILE_CELLS * sizeof(uint32_t)
+                   + o->n_tiles * (sizeof(struct seed_buffer) + sizeof(bool)
+                                   + sizeof(uint32_t) + 4 * sizeof(int64_t));
+    size_t seed_share = budget / 8;
+    o->max_buffers = seed_share / (SEED_BUFFER * sizeof(struct seed));
+    size_t n_slots = budget > fixed + seed_share
+                     ? (budget - fixed - seed_share) / RECORD_SIZE : 0;
+    if (n_slots < 2 || o->max_buffers < 1) {
+        fprintf(stderr, "The memory budget is too small for %zu tiles\n",
+                o->n_tiles);
+        return 1;
+    }
+    if (n_slots > o->n_tiles) {
+        n_slots = o->n_tiles;
+    }
+
+    o->cache = tile_cache_init(o->fd, RECORD_SIZE, o->n_tiles, n_slots);
+    o->queue = malloc(TILE_CELLS * sizeof(uint32_t));
+    o->buffers = calloc(o->n_tiles, sizeof(struct seed_buffer));
+    o->spilled = calloc(o->n_tiles, sizeof(bool));
+    o->pending = malloc(o->n_tiles * sizeof(uint32_t));
+    o->heap = index_heap_init(o->n_tiles);
+    if (!o->cache || !o->queue || !o->buffers || !o->spilled || !o->pending
+        || !o->heap) {
+        fprintf(stderr, "Cannot allocate the search state\n");
+        return 1;
+    }
+    for (size_t t = 0; t < o->n_tiles; t++) {
+        o->pending[t] = UINT32_MAX;
+    }
+    return 0;
+}
+
+/* Solves the maze in the file 'path', text or binary, with a breadth first
+ * search that keeps at most about 'budget' bytes in memory, see struct ooc.
+ * The scratch files go to a new directory in 'dir'. With 'out' the path is
+ * written to it, see write_path(). The distances and the path are the ones
+ * of bfs_solve().
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+static int ooc_solve(const char *path, const char *dir, size_t budget,
+                     FILE *out) {
+    struct ooc o = { .fd = -1, .best = UINT32_MAX };
+    if (setup(&o, path, dir, budget)) {
+        cleanup(&o);
+        return ERROR;
+    }
+
+    int result = ERROR;
+    if (add_seed(&o, o.r_start, o.c_start, 0) == 0) {
+        result = NOT_FOUND;
+        while (index_heap_size(o.heap) > 0
+               && index_heap_top_key(o.heap) < o.best) {
+            size_t t = (size_t) index_heap_pop(o.heap);
+            o.pending[t] = UINT32_MAX;
+            if (run_tile(&o, t)) {
+                debug_print("Could not run a tile in ooc_solve");
+                result = ERROR;
+                break;
+            }
+        }
+    }
+    if (result == NOT_FOUND && o.best != UINT32_MAX) {
+        result = o.best > INT_MAX ? ERROR : (int) o.best;
+    }
+    if (result >= 0 && out && write_path(&o, out)) {
+        debug_print("Could not write the path in ooc_solve");
+        result = ERROR;
+    }
+
+    if (print_stats && result != ERROR) {
+        fprintf(stderr, "stats %ld %ld %ld\n", o.num_of_pushes,
+                o.num_of_pops, (long) o.max_elements);
+        tile_cache_stats(o.cache);
+    }
+    cleanup(&o);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    /* -m sets the memory budget in MB for the tiles and seeds in memory,
+     * -d sets the directory for the scratch files (default: $TMPDIR or /tmp),
+     * -o writes the path to the given file as runs of moves,
+     * -s prints the search statistics and the search time */
+    long megabytes = DEFAULT_MEMORY;
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    const char *path_file = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:d:o:s")) != -1) {
+        switch (opt) {
+        case 'm':
+            megabytes = atol(optarg);
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        case 'o':
+            path_file = optarg;
+            break;
+        case 's':
+            print_stats = true;
+            break;
+        default:
+            fprintf(stderr, USAGE, argv[0]);
+            return 1;
+        }
+    }
+    if (optind + 1 != argc || megabytes < 1) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    FILE *out = NULL;
+    if (path_file) {
+        out = fopen(path_file, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open file %s\n", path_file);
+            return 1;
+        }
+    }
+
+    /* solve maze */
+    struct timespec t_start;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    int path_length = ooc_solve(argv[optind], dir,
+                                (size_t) megabytes << 20, out);
+    if (print_stats) {
+        driver_print_time("time", &t_start);
+    }
+    if (out && fclose(out) != 0) {
+        path_length = ERROR;
+    }
+
+    // The maze never fits in memory, so only the result line is shared
+    const struct driver d = {.name = "ooc"};
+    return driver_report(&d, path_length, stdout);
+}
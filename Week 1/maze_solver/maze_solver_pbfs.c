@@ -0,0 +1,584 @@
+// Needed for sysconf() and pthread barriers
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "driver.h"
+#include "maze.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+#define MAX_THREADS 256
+
+/* A level is expanded by the calling thread alone while the frontier is
+ * smaller than this, waking the pool costs more than it saves. */
+#define SERIAL_FRONTIER 1024
+
+/* Switch to bottom-up when the frontier is more than 1/ALPHA of the floor
+ * tiles that are not visited yet, and back to top-down when it drops below
+ * 1/BETA of all tiles. The values are the ones suggested by Beamer et al. */
+#define ALPHA 14
+#define BETA 24
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+// Number of threads of a search (-t), one per online CPU by default
+static int n_threads = 1;
+
+/* A growable array of tile indices, one per thread for the next frontier. */
+struct buffer {
+    int *data;
+    size_t size;
+    size_t capacity;
+};
+
+/* State shared by the threads of one parallel BFS.
+ *
+ * 'visited' has one bit per tile and is claimed with an atomic OR, walls and
+ * border tiles are set up front so they are never claimed. 'parent' holds
+ * the move into every claimed tile, written only by the thread that claimed
+ * it. In top-down levels the frontier is the list 'frontier', in bottom-up
+ * levels it is the bitmap 'frontier_bits' and the next one is built in
+ * 'next_bits'. Bottom-up threads own whole words, so they never share one. */
+struct pbfs {
+    const struct maze *m;
+    size_t n_cells;
+    size_t n_words;
+    int n_threads;
+
+    _Atomic uint64_t *visited;
+    unsigned char *parent;
+
+    int *frontier;
+    size_t frontier_size;
+    size_t frontier_capacity;
+    uint64_t *frontier_bits;
+    uint64_t *next_bits;
+
+    struct buffer next[MAX_THREADS];
+    size_t next_count[MAX_THREADS];
+    size_t floor_count[MAX_THREADS];
+
+    // Tiles claimed, tiles expanded and the largest level, for -s
+    long n_pushes;
+    long n_pops;
+    long max_frontier;
+
+    bool bottom_up;
+    bool done;
+    pthread_barrier_t start_level;
+    pthread_barrier_t end_level;
+
+    bool ready;
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;
+};
+
+/* Arguments of one worker thread. */
+struct worker {
+    struct pbfs *b;
+    int id;
+};
+
+static bool bit_test(const uint64_t *bits, size_t i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+static bool visited_test(struct pbfs *b, size_t i) {
+    uint64_t word = atomic_load_explicit(&b->visited[i / 64],
+                                         memory_order_relaxed);
+    return (word >> (i % 64)) & 1;
+}
+
+/* Atomically claims tile 'i'. Returns true if this call claimed it. */
+static bool visited_claim(struct pbfs *b, size_t i) {
+    uint64_t bit = UINT64_C(1) << (i % 64);
+    if (atomic_load_explicit(&b->visited[i / 64], memory_order_relaxed)
+        & bit) {
+        return false;
+    }
+    return !(atomic_fetch_or_explicit(&b->visited[i / 64], bit,
+                                      memory_order_relaxed) & bit);
+}
+
+static int buffer_push(struct buffer *buf, int e) {
+    if (buf->size == buf->capacity) {
+        size_t capacity = buf->capacity ? 2 * buf->capacity : 1024;
+        int *data = realloc(buf->data, capacity * sizeof(int));
+        if (data == NULL) {
+            debug_print("Could not grow frontier buffer\n");
+            return 1;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+    buf->data[buf->size++] = e;
+    return 0;
+}
+
+/* Returns the index of the neighbour of 'i' in direction 'move', or -1 if
+ * it is outside the accessible part of the maze. */
+static int neighbour(const struct maze *m, int i, int move) {
+    int r = maze_row(m, i) + m_offsets[move][0];
+    int c = maze_col(m, i) + m_offsets[move][1];
+    return maze_valid_move(m, r, c) ? maze_index(m, r, c) : -1;
+}
+
+/* Returns the word range [first, last) of thread 'id'. */
+static void word_range(const struct pbfs *b, int id, size_t *first,
+                       size_t *last) {
+    *first = b->n_words * (size_t) id / (size_t) b->n_threads;
+    *last = b->n_words * (size_t) (id + 1) / (size_t) b->n_threads;
+}
+
+/* Marks the walls and border tiles in the words of thread 'id' as visited
+ * and counts its floor tiles. */
+static void setup_words(struct pbfs *b, int id) {
+    const struct maze *m = b->m;
+    size_t first, last;
+    word_range(b, id, &first, &last);
+
+    size_t floor = 0;
+    for (size_t w = first; w < last; w++) {
+        uint64_t word = 0;
+        for (int k = 0; k < 64; k++) {
+            size_t i = w * 64 + (size_t) k;
+            if (i >= b->n_cells) {
+                word |= ~UINT64_C(0) << k;
+                break;
+            }
+            int r = maze_row(m, (int) i);
+            int c = maze_col(m, (int) i);
+            if (!maze_valid_move(m, r, c) || maze_get(m, r, c) == WALL) {
+                word |= UINT64_C(1) << k;
+            } else {
+                floor++;
+            }
+        }
+        atomic_store_explicit(&b->visited[w], word, memory_order_relaxed);
+    }
+    b->floor_count[id] = floor;
+}
+
+/* Top-down step: thread 'id' expands its share of the frontier list into its
+ * own next buffer. */
+static int top_down(struct pbfs *b, int id) {
+    size_t first = b->frontier_size * (size_t) id / (size_t) b->n_threads;
+    size_t last = b->frontier_size * (size_t) (id + 1) / (size_t) b->n_threads;
+    struct buffer *next = &b->next[id];
+
+    for (size_t k = first; k < last; k++) {
+        int i = b->frontier[k];
+        for (int move = 0; move < N_MOVES; move++) {
+            int new_index = neighbour(b->m, i, move);
+            if (new_index >= 0 && visited_claim(b, (size_t) new_index)) {
+                b->parent[new_index] = (unsigned char) move;
+                if (buffer_push(next, new_index) == 1) {
+                    return ERROR;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* Bottom-up step: every unvisited floor tile in the words of thread 'id'
+ * looks for a neighbour in the frontier and joins the next frontier if it
+ * has one. */
+static void bottom_up(struct pbfs *b, int id) {
+    size_t first, last;
+    word_range(b, id, &first, &last);
+
+    size_t count = 0;
+    for (size_t w = first; w < last; w++) {
+        uint64_t open = ~atomic_load_explicit(&b->visited[w],
+                                              memory_order_relaxed);
+        uint64_t claimed = 0;
+        while (open) {
+            int k = __builtin_ctzll(open);
+            open &= open - 1;
+            int i = (int) (w * 64 + (size_t) k);
+            for (int move = 0; move < N_MOVES; move++) {
+                // Look at the neighbour the move would come from
+                int from = neighbour(b->m, i, (move + 2) % N_MOVES);
+                if (from >= 0 && bit_test(b->frontier_bits, (size_t) from)) {
+                    b->parent[i] = (unsigned char) move;
+                    claimed |= UINT64_C(1) << k;
+                    count++;
+                    break;
+                }
+            }
+        }
+        b->next_bits[w] = claimed;
+        if (claimed) {
+            atomic_fetch_or_explicit(&b->visited[w], claimed,
+                                     memory_order_relaxed);
+        }
+    }
+    b->next_count[id] = count;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *wk = arg;
+    struct pbfs *b = wk->b;
+
+    pthread_mutex_lock(&b->lock);
+    while (!b->ready) {
+        pthread_cond_wait(&b->ready_cond, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+    if (b->done) {
+        return NULL;
+    }
+
+    setup_words(b, wk->id);
+    pthread_barrier_wait(&b->end_level);
+    while (true) {
+        pthread_barrier_wait(&b->start_level);
+        if (b->done) {
+            break;
+        }
+        if (b->bottom_up) {
+            bottom_up(b, wk->id);
+        } else if (top_down(b, wk->id) == ERROR) {
+            // Leave the tile unqueued, the coordinator sees the error
+            b->next[wk->id].size = SIZE_MAX;
+        }
+        pthread_barrier_wait(&b->end_level);
+    }
+    return NULL;
+}
+
+/* Makes the next frontier the current one after a top-down level: the
+ * per-thread buffers are appended to the frontier list. */
+static int merge_next(struct pbfs *b) {
+    size_t total = 0;
+    for (int t = 0; t < b->n_threads; t++) {
+        if (b->next[t].size == SIZE_MAX) {
+            return ERROR;
+        }
+        total += b->next[t].size;
+    }
+    if (total > b->frontier_capacity) {
+        int *frontier = realloc(b->frontier, total * sizeof(int));
+        if (frontier == NULL) {
+            return ERROR;
+        }
+        b->frontier = frontier;
+        b->frontier_capacity = total;
+    }
+    b->frontier_size = 0;
+    for (int t = 0; t < b->n_threads; t++) {
+        // A thread that never found a tile has no buffer yet
+        if (b->next[t].size == 0) {
+            continue;
+        }
+        memcpy(b->frontier + b->frontier_size, b->next[t].data,
+               b->next[t].size * sizeof(int));
+        b->frontier_size += b->next[t].size;
+        b->next[t].size = 0;
+    }
+    return 0;
+}
+
+/* Converts the frontier list into 'frontier_bits' for a bottom-up level. */
+static void list_to_bits(struct pbfs *b) {
+    memset(b->frontier_bits, 0, b->n_words * sizeof(uint64_t));
+    for (size_t k = 0; k < b->frontier_size; k++) {
+        size_t i = (size_t) b->frontier[k];
+        b->frontier_bits[i / 64] |= UINT64_C(1) << (i % 64);
+    }
+}
+
+/* Converts 'frontier_bits' into the frontier list for a top-down level. */
+static int bits_to_list(struct pbfs *b, size_t count) {
+    if (count > b->frontier_capacity) {
+        int *frontier = realloc(b->frontier, count * sizeof(int));
+        if (frontier == NULL) {
+            return ERROR;
+        }
+        b->frontier = frontier;
+        b->frontier_capacity = count;
+    }
+    b->frontier_size = 0;
+    for (size_t w = 0; w < b->n_words; w++) {
+        for (uint64_t bits = b->frontier_bits[w]; bits; bits &= bits - 1) {
+            b->frontier[b->frontier_size++] =
+                (int) (w * 64 + (size_t) __builtin_ctzll(bits));
+        }
+    }
+    return 0;
+}
+
+/* Runs the levels of the search on the calling thread, which also acts as
+ * thread 0 and decides between the levels which step to use next. */
+static int coordinate(struct pbfs *b, int index_start, int index_destination) {
+    size_t unvisited = 0;
+    for (int t = 0; t < b->n_threads; t++) {
+        unvisited += b->floor_count[t];
+    }
+
+    int result = NOT_FOUND;
+    if (index_start == index_destination) {
+        result = 0;
+    } else if (visited_test(b, (size_t) index_destination)) {
+        // The destination is a wall or on the border, it can't be reached
+        b->frontier_size = 0;
+    } else {
+        b->frontier[0] = index_start;
+        b->frontier_size = 1;
+        b->n_pushes = 1;
+        b->max_frontier = 1;
+        if (visited_claim(b, (size_t) index_start)) {
+            unvisited--;
+        }
+    }
+
+    while (result == NOT_FOUND) {
+        if (visited_test(b, (size_t) index_destination)) {
+            result = 0;
+            break;
+        }
+        if (b->frontier_size == 0) {
+            break;
+        }
+
+        // Pick the direction of this level
+        bool was_bottom_up = b->bottom_up;
+        if (!b->bottom_up && b->frontier_size * ALPHA > unvisited) {
+            list_to_bits(b);
+            b->bottom_up = true;
+        } else if (b->bottom_up && b->frontier_size * BETA < b->n_cells) {
+            b->bottom_up = false;
+        }
+        if (was_bottom_up && !b->bottom_up
+            && bits_to_list(b, b->frontier_size) == ERROR) {
+            result = ERROR;
+            break;
+        }
+
+        b->n_pops += (long) b->frontier_size;
+        if (!b->bottom_up && b->frontier_size < SERIAL_FRONTIER) {
+            // Small level, not worth waking the other threads
+            int n_threads = b->n_threads;
+            b->n_threads = 1;
+            int err = top_down(b, 0);
+            b->n_threads = n_threads;
+            if (err == ERROR) {
+                result = ERROR;
+                break;
+            }
+        } else {
+            pthread_barrier_wait(&b->start_level);
+            if (b->bottom_up) {
+                bottom_up(b, 0);
+            } else if (top_down(b, 0) == ERROR) {
+                b->next[0].size = SIZE_MAX;
+            }
+            pthread_barrier_wait(&b->end_level);
+        }
+
+        if (b->bottom_up) {
+            size_t count = 0;
+            for (int t = 0; t < b->n_threads; t++) {
+                count += b->next_count[t];
+            }
+            uint64_t *bits = b->frontier_bits;
+            b->frontier_bits = b->next_bits;
+            b->next_bits = bits;
+            b->frontier_size = count;
+        } else if (merge_next(b) == ERROR) {
+            result = ERROR;
+            break;
+        }
+        unvisited -= b->frontier_size;
+        b->n_pushes += (long) b->frontier_size;
+        if ((long) b->frontier_size > b->max_frontier) {
+            b->max_frontier = (long) b->frontier_size;
+        }
+    }
+
+    b->done = true;
+    pthread_barrier_wait(&b->start_level);
+    return result;
+}
+
+/* Marks all visited floor tiles VISITED and the path PATH in the maze and
+ * returns the length of the path. */
+static int mark_maze(struct pbfs *b, struct maze *m, int index_start,
+                     int index_destination) {
+    for (size_t w = 0; w < b->n_words; w++) {
+        uint64_t bits = atomic_load_explicit(&b->visited[w],
+                                             memory_order_relaxed);
+        for (; bits; bits &= bits - 1) {
+            size_t i = w * 64 + (size_t) __builtin_ctzll(bits);
+            if (i >= b->n_cells) {
+                break;
+            }
+            int r = maze_row(m, (int) i);
+            int c = maze_col(m, (int) i);
+            if (maze_valid_move(m, r, c) && maze_get(m, r, c) != WALL) {
+                maze_set(m, r, c, VISITED);
+            }
+        }
+    }
+
+    int path_length = 0;
+    int i = index_destination;
+    while (i != index_start) {
+        int move = b->parent[i];
+        i = maze_index(m, maze_row(m, i) - m_offsets[move][0],
+                       maze_col(m, i) - m_offsets[move][1]);
+        maze_set(m, maze_row(m, i), maze_col(m, i), PATH);
+        path_length++;
+    }
+    return path_length;
+}
+
+/* Solves the maze m with a level-synchronous breadth first search on
+ * 'n_threads' threads. Each level is expanded top-down (the frontier claims
+ * its unvisited neighbours) or, when the frontier is a large part of the
+ * unvisited floor, bottom-up (unvisited tiles look for a neighbour in the
+ * frontier). The levels are the same as in bfs_solve(), so the path has the
+ * same length. With 'print_stats' the tiles claimed, the tiles expanded and
+ * the largest level are printed to stderr like the frontier statistics of
+ * bfs_solve().
+ * Returns the length of the path if a path is found.
+ * Returns NOT_FOUND if no path is found and ERROR if an error occured.
+ */
+int pbfs_solve(struct maze *m, int n_threads, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in pbfs_solve");
+        return ERROR;
+    }
+
+    if (n_threads < 1) {
+        n_threads = 1;
+    } else if (n_threads > MAX_THREADS) {
+        n_threads = MAX_THREADS;
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_dest, c_dest;
+    maze_destination(m, &r_dest, &c_dest);
+    int index_destination = maze_index(m, r_dest, c_dest);
+
+    struct pbfs b = {
+        .m = m,
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .ready_cond = PTHREAD_COND_INITIALIZER,
+    };
+    b.n_cells = maze_cells(m);
+    b.n_words = (b.n_cells + 63) / 64;
+    b.visited = calloc(b.n_words, sizeof(uint64_t));
+    b.parent = malloc(b.n_cells);
+    b.frontier_capacity = SERIAL_FRONTIER;
+    b.frontier = malloc(b.frontier_capacity * sizeof(int));
+    b.frontier_bits = calloc(b.n_words, sizeof(uint64_t));
+    b.next_bits = calloc(b.n_words, sizeof(uint64_t));
+
+    int result = ERROR;
+    pthread_t threads[MAX_THREADS];
+    struct worker workers[MAX_THREADS];
+    int started = 1;
+    if (b.visited && b.parent && b.frontier && b.frontier_bits
+        && b.next_bits) {
+        // Start as many workers as possible, they wait until the barriers
+        // are set up for the number that actually runs.
+        pthread_mutex_lock(&b.lock);
+        for (; started < n_threads; started++) {
+            workers[started] = (struct worker) { &b, started };
+            if (pthread_create(&threads[started], NULL, worker_main,
+                               &workers[started]) != 0) {
+                debug_print("Could not start all threads in pbfs_solve");
+                break;
+            }
+        }
+        b.n_threads = started;
+        bool barriers = pthread_barrier_init(&b.start_level, NULL,
+                                             (unsigned) started) == 0;
+        if (barriers && pthread_barrier_init(&b.end_level, NULL,
+                                             (unsigned) started) != 0) {
+            pthread_barrier_destroy(&b.start_level);
+            barriers = false;
+        }
+        b.done = !barriers;
+        b.ready = true;
+        pthread_cond_broadcast(&b.ready_cond);
+        pthread_mutex_unlock(&b.lock);
+
+        if (barriers) {
+            setup_words(&b, 0);
+            pthread_barrier_wait(&b.end_level);
+            result = coordinate(&b, index_start, index_destination);
+        }
+        for (int t = 1; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        if (barriers) {
+            pthread_barrier_destroy(&b.end_level);
+            pthread_barrier_destroy(&b.start_level);
+        }
+    }
+
+    if (print_stats && result != ERROR) {
+        fprintf(stderr, "stats %ld %ld %ld\n", b.n_pushes, b.n_pops,
+                b.max_frontier);
+    }
+    if (result == 0) {
+        result = mark_maze(&b, m, index_start, index_destination);
+    }
+
+    for (int t = 0; t < n_threads; t++) {
+        free(b.next[t].data);
+    }
+    free(b.next_bits);
+    free(b.frontier_bits);
+    free(b.frontier);
+    free(b.parent);
+    free((void *) b.visited);
+    return result;
+}
+
+/* Handles -t, the number of threads of a search. */
+static int option(struct driver *d, int opt, const char *arg) {
+    (void) d;
+    if (opt != 't') {
+        return 1;
+    }
+    n_threads = atoi(arg);
+    return 0;
+}
+
+/* Runs pbfs_solve() with the threads of -t. */
+static int solve(struct maze *m, bool print_stats) {
+    return pbfs_solve(m, n_threads, print_stats);
+}
+
+int main(int argc, char *argv[]) {
+    /* -t sets the number of threads (default: one per online CPU),
+     * see driver.h for the other options */
+    n_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    struct driver d = {
+        .name = "pbfs",
+        .solve = solve,
+        .options = "t:",
+        .usage = "[-t threads] ",
+        .option = option,
+    };
+    return driver_main(&d, argc, argv);
+}
@@ -0,0 +1,81 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "maze.h"
+#include "parent_map.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Four 2-bit direction codes per byte, cell 'i' is stored in byte i / 4 at
+ * bit offset 2 * (i % 4). */
+struct parent_map {
+    unsigned char *codes;
+    size_t n_cells;
+};
+
+struct parent_map *parent_map_init(size_t n_cells) {
+    struct parent_map *p = malloc(sizeof(struct parent_map));
+    if (p == NULL) {
+        debug_print("Could not allocate memory for parent map struct\n");
+        return NULL;
+    }
+
+    p->codes = calloc((n_cells + 3) / 4, 1);
+    if (p->codes == NULL) {
+        debug_print("Could not allocate memory for parent map codes\n");
+        free(p);
+        return NULL;
+    }
+    p->n_cells = n_cells;
+
+    return p;
+}
+
+void parent_map_cleanup(struct parent_map *p) {
+    if (p == NULL) {
+        debug_print("Invalid parent map struct in parent_map_cleanup\n");
+        return;
+    }
+
+    free(p->codes);
+    free(p);
+}
+
+void parent_map_set(struct parent_map *p, int64_t index, int move) {
+    size_t byte = (size_t) index / 4;
+    int shift = (int) (2 * (index % 4));
+    p->codes[byte] = (unsigned char) ((p->codes[byte] & ~(3 << shift))
+                                      | (move << shift));
+}
+
+int parent_map_get(const struct parent_map *p, int64_t index) {
+    return (p->codes[(size_t) index / 4] >> (2 * (index % 4))) & 3;
+}
+
+int64_t parent_map_parent(const struct parent_map *p, const struct maze *m,
+                          int64_t index) {
+    int move = parent_map_get(p, index);
+    return maze_index64(m, maze_row64(m, index) - m_offsets[move][0],
+                        maze_col64(m, index) - m_offsets[move][1]);
+}
+
+int parent_map_trace(const struct parent_map *p, struct maze *m,
+                     int64_t from, int64_t to) {
+    int path_length = 0;
+    int64_t i = to;
+
+    // While not at the start, move to the predecessor
+    while (i != from) {
+        i = parent_map_parent(p, m, i);
+        maze_set(m, maze_row64(m, i), maze_col64(m, i), PATH);
+        path_length++;
+    }
+
+    return path_length;
+}
@@ -0,0 +1,37 @@
+#include <stddef.h>
+#include <stdint.h>
+
+/* Handle to a parent map.
+ *
+ * A parent map records for every cell of a maze from which direction it was
+ * first reached during a search. The direction is the index into m_offsets
+ * of the move that entered the cell, so it fits in 2 bits and four cells
+ * share one byte. */
+struct parent_map;
+
+/* Forward declaration for using a struct maze pointer in the prototypes. */
+struct maze;
+
+/* Return a pointer to a parent map for a maze with 'n_cells' cells if
+ * successful, otherwise return NULL. */
+struct parent_map *parent_map_init(size_t n_cells);
+
+/* Cleanup parent map. */
+void parent_map_cleanup(struct parent_map *p);
+
+/* Record that the cell at 'index' was entered with move 'move'. Indices are
+ * 64-bit, so the map works for mazes of any size. */
+void parent_map_set(struct parent_map *p, int64_t index, int move);
+
+/* Return the move that entered the cell at 'index'. */
+int parent_map_get(const struct parent_map *p, int64_t index);
+
+/* Return the index of the cell the search came from to reach 'index'. */
+int64_t parent_map_parent(const struct parent_map *p, const struct maze *m,
+                          int64_t index);
+
+/* Walk back from cell 'to' to cell 'from' and mark every cell on the way,
+ * except 'to' itself, as PATH in maze 'm'.
+ * Return the number of moves from 'from' to 'to'. */
+int parent_map_trace(const struct parent_map *p, struct maze *m,
+                     int64_t from, int64_t to);
@@ -0,0 +1,152 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "maze.h"
+#include "parent_map.h"
+#include "path.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+#define INITIAL_CAPACITY 64
+
+/* A run holds its direction in the low 2 bits and its number of moves in
+ * the others, a longer run is split. */
+#define RUN_SHIFT 2
+#define MAX_RUN (UINT32_MAX >> RUN_SHIFT)
+
+/* Run-length letters, in the order of m_offsets. */
+static const char directions[] = "URDL";
+
+struct path {
+    uint32_t *runs;
+    size_t n_runs;
+    size_t capacity;
+    int64_t start;
+    int64_t length;
+};
+
+struct path *path_init(void) {
+    struct path *p = malloc(sizeof(struct path));
+    if (p == NULL) {
+        debug_print("Could not allocate memory for path struct\n");
+        return NULL;
+    }
+
+    p->runs = malloc(INITIAL_CAPACITY * sizeof(uint32_t));
+    if (p->runs == NULL) {
+        debug_print("Could not allocate memory for path runs\n");
+        free(p);
+        return NULL;
+    }
+    p->capacity = INITIAL_CAPACITY;
+    path_clear(p, 0);
+
+    return p;
+}
+
+void path_cleanup(struct path *p) {
+    if (p == NULL) {
+        debug_print("Invalid path struct in path_cleanup\n");
+        return;
+    }
+
+    free(p->runs);
+    free(p);
+}
+
+void path_clear(struct path *p, int64_t start) {
+    p->n_runs = 0;
+    p->start = start;
+    p->length = 0;
+}
+
+int path_append(struct path *p, int move) {
+    if (p->n_runs > 0) {
+        uint32_t *last = &p->runs[p->n_runs - 1];
+        if ((int) (*last & 3) == move && (*last >> RUN_SHIFT) < MAX_RUN) {
+            *last += 1 << RUN_SHIFT;
+            p->length++;
+            return 0;
+        }
+    }
+
+    if (p->n_runs == p->capacity) {
+        uint32_t *runs = realloc(p->runs, 2 * p->capacity * sizeof(uint32_t));
+        if (runs == NULL) {
+            debug_print("Could not grow the runs in path_append\n");
+            return 1;
+        }
+        p->runs = runs;
+        p->capacity *= 2;
+    }
+    p->runs[p->n_runs++] = (1 << RUN_SHIFT) | (uint32_t) move;
+    p->length++;
+    return 0;
+}
+
+void path_reverse(struct path *p) {
+    for (size_t k = 0; k < p->n_runs / 2; k++) {
+        uint32_t run = p->runs[k];
+        p->runs[k] = p->runs[p->n_runs - 1 - k];
+        p->runs[p->n_runs - 1 - k] = run;
+    }
+}
+
+int64_t path_trace(struct path *p, const struct parent_map *parents,
+                   const struct maze *m, int64_t from, int64_t to) {
+    int64_t cols = maze_cols(m);
+    path_clear(p, maze_row64(m, from) * cols + maze_col64(m, from));
+
+    // The moves come last first, so the runs are reversed at the end
+    int64_t i = to;
+    while (i != from) {
+        if (path_append(p, parent_map_get(parents, i))) {
+            debug_print("Could not append to path in path_trace\n");
+            return -1;
+        }
+        i = parent_map_parent(parents, m, i);
+    }
+    path_reverse(p);
+
+    return p->length;
+}
+
+int64_t path_start(const struct path *p) {
+    return p->start;
+}
+
+int64_t path_length(const struct path *p) {
+    return p->length;
+}
+
+size_t path_runs(const struct path *p) {
+    return p->n_runs;
+}
+
+void path_run(const struct path *p, size_t k, int *move, int64_t *count) {
+    *move = (int) (p->runs[k] & 3);
+    *count = p->runs[k] >> RUN_SHIFT;
+}
+
+int path_write(const struct path *p, FILE *fp) {
+    fprintf(fp, "%lld %lld\n", (long long) p->start, (long long) p->length);
+
+    // A line per 16 runs keeps the file readable
+    for (size_t k = 0; k < p->n_runs; k++) {
+        fprintf(fp, "%u%c%c", (unsigned) (p->runs[k] >> RUN_SHIFT),
+                directions[p->runs[k] & 3],
+                k % 16 == 15 || k + 1 == p->n_runs ? '\n' : ' ');
+    }
+    return ferror(fp) != 0;
+}
+
+int path_write_none(FILE *fp) {
+    fprintf(fp, "-1 -1\n");
+    return ferror(fp) != 0;
+}
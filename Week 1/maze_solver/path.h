@@ -0,0 +1,67 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Handle to a path.
+ *
+ * A path is stored as the index of its first cell, row * columns + column
+ * whatever the layout of the maze, and the moves that follow it as runs of
+ * the same m_offsets direction. A corridor of any length is one run of 4
+ * bytes, so even a path of millions of moves takes a few kilobytes and the
+ * maze does not have to be marked or printed to get it. */
+struct path;
+
+/* Forward declarations for using struct maze and struct parent_map pointers
+ * in the prototypes. */
+struct maze;
+struct parent_map;
+
+/* Return a pointer to an empty path starting at index 0 if successful,
+ * otherwise return NULL. */
+struct path *path_init(void);
+
+/* Cleanup path. */
+void path_cleanup(struct path *p);
+
+/* Remove every move of the path and let it start at index 'start'. */
+void path_clear(struct path *p, int64_t start);
+
+/* Append move 'move', an index into m_offsets, to the end of the path.
+ * Return 0 if successful, 1 otherwise. */
+int path_append(struct path *p, int move);
+
+/* Reverse the order of the moves of the path, not their directions. */
+void path_reverse(struct path *p);
+
+/* Walk back from cell 'to' to cell 'from' of maze 'm' along the parents of
+ * 'parents' like parent_map_trace(), but store the moves from 'from' to 'to'
+ * in 'p' instead of marking them in the maze.
+ * Return the number of moves from 'from' to 'to', or -1 if 'p' could not
+ * grow. */
+int64_t path_trace(struct path *p, const struct parent_map *parents,
+                   const struct maze *m, int64_t from, int64_t to);
+
+/* Return the index of the first cell of the path. */
+int64_t path_start(const struct path *p);
+
+/* Return the number of moves of the path. */
+int64_t path_length(const struct path *p);
+
+/* Return the number of runs of the path. */
+size_t path_runs(const struct path *p);
+
+/* Store the direction and the number of moves of run 'k' in 'move' and
+ * 'count'. */
+void path_run(const struct path *p, size_t k, int *move, int64_t *count);
+
+/* Write the path to 'fp' as text. The first line holds the start index and
+ * the number of moves, the next lines the runs, each the number of moves
+ * followed by U, R, D or L for the directions of m_offsets, e.g. '12R'.
+ * Return 0 if successful, 1 otherwise. */
+int path_write(const struct path *p, FILE *fp);
+
+/* Write the record of a search without a path to 'fp' in the format of
+ * path_write(): a first line of -1 -1 and no runs, so a file of paths has a
+ * record for every search.
+ * Return 0 if successful, 1 otherwise. */
+int path_write_none(FILE *fp);
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "queue.h"
 
@@ -9,6 +10,10 @@
 #define debug_print(fmt) \
             do { if (DEBUG) fprintf(stderr, fmt); } while (0)
 
+/* The queue is a ring buffer whose capacity is always a power of two, so
+ * wrapping an index around is a mask with 'capacity - 1' instead of a modulo.
+ * 'rear' is the position of the first element, the elements occupy the
+ * (possibly wrapped) region [rear, rear + size). */
 struct queue {
     int *data;
     size_t rear;
@@ -21,13 +26,52 @@ struct queue {
     size_t capacity;
 };
 
+/* Return the smallest power of two that is at least 'n' (and at least 1). */
+static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while(p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/* Grow the ring buffer of 'q' so it can hold at least 'needed' elements.
+ * The wrapped part of the occupied region is moved behind the old end of the
+ * buffer, so the elements are contiguous again in the larger buffer.
+ * Return 0 if successful, 1 otherwise. */
+static int queue_grow(struct queue *q, size_t needed) {
+    size_t old_capacity = q->capacity;
+    size_t new_capacity = round_up_pow2(needed);
+    if(new_capacity <= old_capacity) {
+        return 0;
+    }
+
+    int *data = realloc(q->data, sizeof(int) * new_capacity);
+    if(data == NULL) {
+        debug_print("Could not grow queue data\n");
+        return 1;
+    }
+
+    // Unwrap: the elements in [0, rear + size - old_capacity) belong after
+    // the elements in [rear, old_capacity).
+    if(q->rear + q->size > old_capacity) {
+        size_t wrapped = q->rear + q->size - old_capacity;
+        memcpy(data + old_capacity, data, sizeof(int) * wrapped);
+    }
+
+    q->data = data;
+    q->capacity = new_capacity;
+    return 0;
+}
+
 struct queue *queue_init(size_t capacity) {
     struct queue *queue_ptr = malloc(sizeof(struct queue));
     if(queue_ptr == NULL) {
         debug_print("Could not allocate memory for queue struct\n");
         return NULL;
     }
-    
+
+    capacity = round_up_pow2(capacity);
     queue_ptr->data = malloc(sizeof(int) * capacity);
     if(queue_ptr->data == NULL) {
         debug_print("Could not allocate memory for queue data\n");
@@ -68,7 +112,7 @@ void queue_stats(const struct queue *q) {
         return;
     }
 
-    fprintf(stderr, "stats %d %d %ld\n", 
+    fprintf(stderr, "stats %d %d %zu\n", 
                     q->num_of_pushes, 
                     q->num_of_pops, 
                     q->max_elements);
@@ -85,12 +129,12 @@ int queue_push(struct queue *q, int e) {
         return 1;
     }
 
-    if(q->size == q->capacity) {
-        debug_print("Queue is full, element not added\n");
+    if(q->size == q->capacity && queue_grow(q, q->capacity * 2) == 1) {
+        debug_print("Queue is full and can't grow, element not added\n");
         return 1;
     }
 
-    size_t front = (q->rear + q->size) % q->capacity;
+    size_t front = (q->rear + q->size) & (q->capacity - 1);
 
     q->data[front] = e;
     q->size++;
@@ -115,15 +159,81 @@ int queue_pop(struct queue *q) {
     }
 
     int element = q->data[q->rear];
-    q->rear++;
+    q->rear = (q->rear + 1) & (q->capacity - 1);
     q->size--;
     q->num_of_pops++;
 
-    if(q->rear >= q->capacity) {
-        q->rear = 0;
+    return element;
+}
+
+int queue_push_n(struct queue *q, const int *elements, size_t n) {
+    if(q == NULL || (elements == NULL && n > 0)) {
+        debug_print("Invalid arguments in queue_push_n\n");
+        return 1;
+    }
+
+    if(n == 0) {
+        return 0;
+    }
+
+    for(size_t i = 0; i < n; i++) {
+        if(elements[i] < 0) {
+            debug_print("No negative numbers are allowed in the queue\n");
+            return 1;
+        }
     }
 
-    return element;
+    if(q->size + n > q->capacity && queue_grow(q, q->size + n) == 1) {
+        debug_print("Queue is full and can't grow, elements not added\n");
+        return 1;
+    }
+
+    // Copy in at most two contiguous pieces: up to the end of the buffer and
+    // the remainder from the start of the buffer.
+    size_t front = (q->rear + q->size) & (q->capacity - 1);
+    size_t first = q->capacity - front;
+    if(first > n) {
+        first = n;
+    }
+    memcpy(q->data + front, elements, sizeof(int) * first);
+    memcpy(q->data, elements + first, sizeof(int) * (n - first));
+
+    q->size += n;
+    q->num_of_pushes += (int) n;
+
+    if(q->size > q->max_elements) {
+        q->max_elements = q->size;
+    }
+
+    return 0;
+}
+
+size_t queue_pop_n(struct queue *q, int *elements, size_t n) {
+    if(q == NULL || (elements == NULL && n > 0)) {
+        debug_print("Invalid arguments in queue_pop_n\n");
+        return 0;
+    }
+
+    if(n > q->size) {
+        n = q->size;
+    }
+
+    if(n == 0) {
+        return 0;
+    }
+
+    size_t first = q->capacity - q->rear;
+    if(first > n) {
+        first = n;
+    }
+    memcpy(elements, q->data + q->rear, sizeof(int) * first);
+    memcpy(elements + first, q->data, sizeof(int) * (n - first));
+
+    q->rear = (q->rear + n) & (q->capacity - 1);
+    q->size -= n;
+    q->num_of_pops += (int) n;
+
+    return n;
 }
 
 int queue_peek(const struct queue *q) {
@@ -4,8 +4,10 @@
 /* Handle to queue */
 struct queue;
 
-/* Return a pointer to a queue data structure with a maximum capacity of
- * 'capacity' if successful, otherwise return NULL. */
+/* Return a pointer to a queue data structure with an initial capacity of
+ * 'capacity' if successful, otherwise return NULL.
+ * The capacity is rounded up to a power of two and the queue grows on demand
+ * when it is full, so 'capacity' is only a hint. */
 struct queue *queue_init(size_t capacity);
 
 /* Cleanup queue. */
@@ -19,6 +21,15 @@ void queue_stats(const struct queue *q);
  * Return 0 if successful, 1 otherwise. */
 int queue_push(struct queue *q, int e);
 
+/* Push the 'n' items in 'elements' to the end of the queue, in order.
+ * Either all items are pushed or none are.
+ * Return 0 if successful, 1 otherwise. */
+int queue_push_n(struct queue *q, const int *elements, size_t n);
+
+/* Remove up to 'n' items from the front of the queue and store them in order
+ * in 'elements'. Return the number of items removed. */
+size_t queue_pop_n(struct queue *q, int *elements, size_t n);
+
 /* Remove the first item from queue and return it.
  * Return the first item if successful, -1 otherwise. */
 int queue_pop(struct queue *q);
@@ -0,0 +1,274 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "frontier.h"
+#include "maze.h"
+#include "parent_map.h"
+#include "path.h"
+#include "queue.h"
+#include "search.h"
+
+#define NOT_FOUND -1
+#define ERROR -2
+#define INITIAL_CAPACITY 4096
+
+/* Cells of a BFS level that bfs_solve_bidirectional() takes from its queue
+ * at once. */
+#define LEVEL_BATCH 256
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* 32-bit indices, for every maze with at most INT_MAX cells. */
+#define SEARCH_INDEX int
+#define SEARCH_FRONTIER frontier
+#define SEARCH_MAZE(fn) fn
+#define SEARCH_FN(fn) fn##32
+#include "search_core.h"
+#undef SEARCH_INDEX
+#undef SEARCH_FRONTIER
+#undef SEARCH_MAZE
+#undef SEARCH_FN
+
+/* 64-bit indices, for larger mazes. */
+#define SEARCH_INDEX int64_t
+#define SEARCH_FRONTIER frontier64
+#define SEARCH_MAZE(fn) fn##64
+#define SEARCH_FN(fn) fn##64
+#include "search_core.h"
+#undef SEARCH_INDEX
+#undef SEARCH_FRONTIER
+#undef SEARCH_MAZE
+#undef SEARCH_FN
+
+/* Returns true if the cells of 'm' can be indexed with an int. */
+static bool fits_int(const struct maze *m) {
+    return maze_cells(m) <= INT_MAX;
+}
+
+int bfs_solve(struct maze *m, bool print_stats) {
+    return bfs_solve_path(m, print_stats, NULL);
+}
+
+int dfs_solve(struct maze *m, bool print_stats) {
+    return dfs_solve_path(m, print_stats, NULL);
+}
+
+int bfs_solve_path(struct maze *m, bool print_stats, struct path *path) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in bfs_solve");
+        return ERROR;
+    }
+    return fits_int(m) ? bfs32(m, print_stats, path)
+                       : bfs64(m, print_stats, path);
+}
+
+int dfs_solve_path(struct maze *m, bool print_stats, struct path *path) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in dfs_solve");
+        return ERROR;
+    }
+    return fits_int(m) ? dfs32(m, print_stats, path)
+                       : dfs64(m, print_stats, path);
+}
+
+/* Returns true if bit 'i' is set in 'bits'. */
+static bool bit_test(const uint64_t *bits, int i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+/* Walks from cell 'from' towards the destination 'to' along the parents of
+ * the backward search and marks every cell on the way, except 'to', as PATH.
+ * Returns the number of moves from 'from' to 'to'. */
+static int trace_backward(const struct parent_map *p, struct maze *m,
+                          int from, int to) {
+    int path_length = 0;
+    int i = from;
+
+    while (i != to) {
+        maze_set(m, maze_row(m, i), maze_col(m, i), PATH);
+        i = (int) parent_map_parent(p, m, i);
+        path_length++;
+    }
+
+    return path_length;
+}
+
+/* Claims every FLOOR neighbour of the cell at 'i' for this side of the
+ * search and appends it to 'next' at '*n_next', cells of the backward search
+ * are recorded in 'backward'. If a neighbour belongs to the other side, the
+ * two searches have met and the cells on both sides of the meeting are
+ * stored in 'own' and 'other'. 'cells' and 'deltas' are used as in
+ * expand_cells() if 'cells' is not NULL.
+ * Returns 1 if the searches met, 0 otherwise. */
+static int expand_cell(struct maze *m, char *cells, const int *deltas,
+                       struct parent_map *p, uint64_t *backward,
+                       bool is_backward, int i, int *next, size_t *n_next,
+                       int *own, int *other) {
+    int r = cells ? 0 : maze_row(m, i);
+    int c = cells ? 0 : maze_col(m, i);
+
+    for (int move = 0; move < N_MOVES; move++) {
+        int new_index;
+        char new_position;
+        if (cells) {
+            new_index = i + deltas[move];
+            new_position = cells[new_index];
+        } else {
+            int new_r = r + m_offsets[move][0];
+            int new_c = c + m_offsets[move][1];
+            if (!maze_valid_move(m, new_r, new_c)) {
+                continue;
+            }
+            new_index = maze_index(m, new_r, new_c);
+            new_position = maze_get(m, new_r, new_c);
+        }
+
+        if (new_position == FLOOR) {
+            if (cells) {
+                cells[new_index] = VISITED;
+            } else {
+                maze_set(m, r + m_offsets[move][0], c + m_offsets[move][1],
+                         VISITED);
+            }
+            parent_map_set(p, new_index, move);
+            if (is_backward) {
+                backward[new_index / 64] |= UINT64_C(1) << (new_index % 64);
+            }
+            next[(*n_next)++] = new_index;
+        } else if (new_position == VISITED
+                   && bit_test(backward, new_index) != is_backward) {
+            *own = i;
+            *other = new_index;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Expands one complete BFS level of the queue 'q', see expand_cell(). The
+ * level is taken from the front of the queue LEVEL_BATCH cells at a time
+ * with queue_pop_n() and the cells they claim are added at the back with
+ * one queue_push_n() per batch.
+ * Returns 1 if the searches met, 0 if not and ERROR if an error occured. */
+static int expand_level(struct maze *m, char *cells, const int *deltas,
+                        struct queue *q, struct parent_map *p,
+                        uint64_t *backward, bool is_backward,
+                        int *own, int *other) {
+    int batch[LEVEL_BATCH];
+    int next[LEVEL_BATCH * N_MOVES];
+    size_t level_size = queue_size(q);
+
+    while (level_size > 0) {
+        size_t n = queue_pop_n(q, batch, level_size < LEVEL_BATCH
+                                         ? level_size : LEVEL_BATCH);
+        level_size -= n;
+
+        size_t n_next = 0;
+        int met = 0;
+        for (size_t k = 0; k < n && !met; k++) {
+            met = expand_cell(m, cells, deltas, p, backward, is_backward,
+                              batch[k], next, &n_next, own, other);
+        }
+
+        if (queue_push_n(q, next, n_next)) {
+            debug_print("Could not push to queue in expand_level");
+            return ERROR;
+        }
+        if (met) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* The frontiers are queues of queue.c. Every step expands a whole level of
+ * the smaller frontier, so the first meeting found is on a shortest path.
+ * Mazes too large for int indices are solved with a single bfs_solve(). */
+int bfs_solve_bidirectional(struct maze *m, bool print_stats) {
+    if (m == NULL) {
+        debug_print("Pointer to maze struct is NULL in "
+                    "bfs_solve_bidirectional");
+        return ERROR;
+    }
+    if (!fits_int(m)) {
+        return bfs_solve(m, print_stats);
+    }
+
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    int index_start = maze_index(m, r_start, c_start);
+
+    int r_destination, c_destination;
+    maze_destination(m, &r_destination, &c_destination);
+    int index_destination = maze_index(m, r_destination, c_destination);
+
+    if (index_start == index_destination) {
+        return 0;
+    }
+
+    // Both searches share one parent map, every cell is claimed by one side
+    size_t n_cells = maze_cells(m);
+    struct queue *forward_q = queue_init(INITIAL_CAPACITY);
+    struct queue *backward_q = queue_init(INITIAL_CAPACITY);
+    struct parent_map *p = parent_map_init(n_cells);
+    uint64_t *backward = calloc((n_cells + 63) / 64, sizeof(uint64_t));
+
+    char *cells = maze_data(m);
+    int deltas[N_MOVES];
+    maze_index_deltas(m, deltas);
+
+    int result = NOT_FOUND;
+    if (forward_q == NULL || backward_q == NULL || p == NULL
+        || backward == NULL) {
+        debug_print("Could not initialize bfs_solve_bidirectional");
+        result = ERROR;
+    } else {
+        queue_push(forward_q, index_start);
+        queue_push(backward_q, index_destination);
+        maze_set(m, r_start, c_start, VISITED);
+        maze_set(m, r_destination, c_destination, VISITED);
+        backward[index_destination / 64] |=
+            UINT64_C(1) << (index_destination % 64);
+    }
+
+    while (result == NOT_FOUND && !queue_empty(forward_q)
+           && !queue_empty(backward_q)) {
+        bool is_backward = queue_size(backward_q) < queue_size(forward_q);
+        struct queue *q = is_backward ? backward_q : forward_q;
+
+        int own, other;
+        int met = expand_level(m, cells, deltas, q, p, backward, is_backward,
+                               &own, &other);
+        if (met == ERROR) {
+            result = ERROR;
+        } else if (met) {
+            // Join the two halves at the edge between 'own' and 'other'
+            int forward_end = is_backward ? other : own;
+            int backward_end = is_backward ? own : other;
+            result = parent_map_trace(p, m, index_start, forward_end);
+            maze_set(m, maze_row(m, forward_end), maze_col(m, forward_end),
+                     PATH);
+            result += 1 + trace_backward(p, m, backward_end,
+                                         index_destination);
+        }
+    }
+
+    if (print_stats && result != ERROR) {
+        queue_stats(forward_q);
+        queue_stats(backward_q);
+    }
+    free(backward);
+    parent_map_cleanup(p);
+    queue_cleanup(backward_q);
+    queue_cleanup(forward_q);
+    return result;
+}
@@ -0,0 +1,31 @@
+#include <stdbool.h>
+
+/* Uninformed searches from the start to the destination of a maze.
+ *
+ * All of them mark the cells they reach as VISITED and the cells of the path
+ * they find as PATH, except the destination. They return the length of the
+ * path, -1 if there is no path and -2 if an error occured. With
+ * 'print_stats' the statistics of the frontier are printed to stderr in the
+ * format 'stats' num_of_pushes num_of_pops max_elements. */
+
+/* Forward declarations for using struct maze and struct path pointers in
+ * the prototypes. */
+struct maze;
+struct path;
+
+/* Breadth first search, finds a shortest path. */
+int bfs_solve(struct maze *m, bool print_stats);
+
+/* Depth first search, finds a path but usually not a shortest one. */
+int dfs_solve(struct maze *m, bool print_stats);
+
+/* Same as bfs_solve() and dfs_solve(), but if 'path' is not NULL the path is
+ * stored in it as runs of moves, see path.h, and not marked PATH in the
+ * maze. */
+int bfs_solve_path(struct maze *m, bool print_stats, struct path *path);
+int dfs_solve_path(struct maze *m, bool print_stats, struct path *path);
+
+/* Two breadth first searches, one from the start and one from the
+ * destination, until their frontiers meet. Finds a shortest path and prints
+ * the statistics of both frontiers. */
+int bfs_solve_bidirectional(struct maze *m, bool print_stats);
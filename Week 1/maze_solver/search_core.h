@@ -0,0 +1,187 @@
+/* The bodies of the searches, generated once for every index width.
+ * search.c includes this file after defining:
+ *
+ *   SEARCH_INDEX     the type of a cell index, int or int64_t
+ *   SEARCH_FRONTIER  the frontier of that type, frontier or frontier64
+ *   SEARCH_MAZE(fn)  the maze function 'fn' for that type, e.g. maze_index
+ *                    or maze_index64
+ *   SEARCH_FN(fn)    the name of the generated function 'fn', which must be
+ *                    unique for every width
+ *
+ * The generated functions
+ *
+ *   static int SEARCH_FN(bfs)(struct maze *m, bool print_stats,
+ *                             struct path *path)
+ *   static int SEARCH_FN(dfs)(struct maze *m, bool print_stats,
+ *                             struct path *path)
+ *
+ * return the length of the path that they mark, or store in 'path' if it is
+ * not NULL, NOT_FOUND if there is no path or ERROR if an error occured. Both
+ * call the same inline search with a constant frontier order, and the
+ * frontier and the expansion are inline too, so the compiler sees the whole
+ * hot loop for every order. */
+#define SEARCH_F(fn) FRONTIER_CAT(SEARCH_FRONTIER, fn)
+
+/* Pushes every FLOOR neighbour of the cell at 'i' onto 'f', marks it
+ * VISITED and records the move into it in 'p'. Works on the raw 'cells' of
+ * maze_data() with the index 'deltas', the WALL border keeps every
+ * neighbour inside the maze.
+ * Returns 0 if successful, 1 if the frontier could not grow. */
+static inline int SEARCH_FN(expand_cells)(char *cells,
+                                          const int deltas[N_MOVES],
+                                          struct SEARCH_FRONTIER *f,
+                                          struct parent_map *p,
+                                          SEARCH_INDEX i) {
+    for (int move = 0; move < N_MOVES; move++) {
+        SEARCH_INDEX new_index = i + deltas[move];
+        if (cells[new_index] != FLOOR) {
+            continue;
+        }
+        if (SEARCH_F(push)(f, new_index)) {
+            return 1;
+        }
+        cells[new_index] = VISITED;
+        parent_map_set(p, new_index, move);
+    }
+    return 0;
+}
+
+/* Same as expand_cells() for the raw 'cells' of maze_tile_data(), which
+ * move between indices with maze_tile_step() instead of deltas. */
+static inline int SEARCH_FN(expand_tiles)(char *cells,
+                                          const struct maze_tile_steps *steps,
+                                          struct SEARCH_FRONTIER *f,
+                                          struct parent_map *p,
+                                          SEARCH_INDEX i) {
+    for (int move = 0; move < N_MOVES; move++) {
+        SEARCH_INDEX new_index = (SEARCH_INDEX) maze_tile_step(steps, i,
+                                                               move);
+        if (cells[new_index] != FLOOR) {
+            continue;
+        }
+        if (SEARCH_F(push)(f, new_index)) {
+            return 1;
+        }
+        cells[new_index] = VISITED;
+        parent_map_set(p, new_index, move);
+    }
+    return 0;
+}
+
+/* Same as expand_cells(), through the maze interface, for mazes without
+ * maze_data() or maze_tile_data(). */
+static int SEARCH_FN(expand_maze)(struct maze *m, struct SEARCH_FRONTIER *f,
+                                  struct parent_map *p, SEARCH_INDEX i) {
+    int r = SEARCH_MAZE(maze_row)(m, i);
+    int c = SEARCH_MAZE(maze_col)(m, i);
+    for (int move = 0; move < N_MOVES; move++) {
+        int new_r = r + m_offsets[move][0];
+        int new_c = c + m_offsets[move][1];
+        if (!maze_valid_move(m, new_r, new_c)
+            || maze_get(m, new_r, new_c) != FLOOR) {
+            continue;
+        }
+
+        SEARCH_INDEX new_index = SEARCH_MAZE(maze_index)(m, new_r, new_c);
+        if (SEARCH_F(push)(f, new_index)) {
+            return 1;
+        }
+        maze_set(m, new_r, new_c, VISITED);
+
+        // Save the move into the cell to recover the path later
+        parent_map_set(p, new_index, move);
+    }
+    return 0;
+}
+
+/* The search itself, a queue if 'lifo' is false and a stack otherwise. */
+static inline int SEARCH_FN(search)(struct maze *m, bool print_stats,
+                                    bool lifo, struct path *path) {
+    int r_start, c_start;
+    maze_start(m, &r_start, &c_start);
+    SEARCH_INDEX index_start = SEARCH_MAZE(maze_index)(m, r_start, c_start);
+
+    int r_destination, c_destination;
+    maze_destination(m, &r_destination, &c_destination);
+    SEARCH_INDEX index_destination =
+        SEARCH_MAZE(maze_index)(m, r_destination, c_destination);
+
+    struct SEARCH_FRONTIER f;
+    if (SEARCH_F(init)(&f, INITIAL_CAPACITY)) {
+        debug_print("Could not initialize frontier in search");
+        return ERROR;
+    }
+
+    // One 2-bit parent direction per cell, sized to this maze
+    struct parent_map *p = parent_map_init(maze_cells(m));
+    if (p == NULL) {
+        debug_print("Could not initialize parent map in search");
+        SEARCH_F(cleanup)(&f);
+        return ERROR;
+    }
+
+    // The start is visited before it is expanded, like every other cell
+    SEARCH_F(push)(&f, index_start);
+    maze_set(m, r_start, c_start, VISITED);
+
+    // Walk the raw cells when the maze allows it, see maze_data() and
+    // maze_tile_data()
+    char *cells = maze_data(m);
+    int deltas[N_MOVES];
+    maze_index_deltas(m, deltas);
+    struct maze_tile_steps steps;
+    char *tiles = cells ? NULL : maze_tile_data(m, &steps);
+
+    int result = NOT_FOUND;
+    while (!SEARCH_F(empty)(&f)) {
+        SEARCH_INDEX i = lifo ? SEARCH_F(pop_back)(&f)
+                              : SEARCH_F(pop_front)(&f);
+        if (i == index_destination) {
+            if (path == NULL) {
+                result = parent_map_trace(p, m, index_start,
+                                          index_destination);
+            } else if (path_trace(path, p, m, index_start,
+                                  index_destination) < 0) {
+                result = ERROR;
+            } else {
+                result = (int) path_length(path);
+            }
+            break;
+        }
+
+        int err;
+        if (cells) {
+            err = SEARCH_FN(expand_cells)(cells, deltas, &f, p, i);
+        } else if (tiles) {
+            err = SEARCH_FN(expand_tiles)(tiles, &steps, &f, p, i);
+        } else {
+            err = SEARCH_FN(expand_maze)(m, &f, p, i);
+        }
+        if (err) {
+            debug_print("Could not push to frontier in search");
+            result = ERROR;
+            break;
+        }
+    }
+
+    if (print_stats && result != ERROR) {
+        SEARCH_F(stats)(&f);
+    }
+    parent_map_cleanup(p);
+    SEARCH_F(cleanup)(&f);
+    return result;
+}
+
+/* Breadth first: the frontier is a queue. */
+static int SEARCH_FN(bfs)(struct maze *m, bool print_stats,
+                          struct path *path) {
+    return SEARCH_FN(search)(m, print_stats, false, path);
+}
+
+/* Depth first: the frontier is a stack. */
+static int SEARCH_FN(dfs)(struct maze *m, bool print_stats,
+                          struct path *path) {
+    return SEARCH_FN(search)(m, print_stats, true, path);
+}
+
+#undef SEARCH_F
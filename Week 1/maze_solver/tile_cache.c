@@ -0,0 +1,244 @@
+// Needed for pread() and pwrite()
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tile_cache.h"
+
+/*  Source: https://stackoverflow.com/questions/1644868/
+    define-macro-for-debug-printing-in-c */
+#define DEBUG 0
+#define debug_print(fmt) \
+            do { if (DEBUG) fprintf(stderr, fmt); } while (0)
+
+/* Marks a slot that holds no record and the ends of the LRU list. */
+#define NONE -1
+
+/* One slot of memory for a record. The slots are in a doubly linked list
+ * from the most recently used ('head') to the least recently used ('tail'). */
+struct slot {
+    size_t record;
+    bool dirty;
+    int prev;
+    int next;
+};
+
+/* 'slot_of' maps every record to its slot or NONE, 'data' holds the
+ * records of all slots one after the other. */
+struct tile_cache {
+    int fd;
+    size_t record_size;
+    size_t n_records;
+    int n_slots;
+    struct slot *slots;
+    int *slot_of;
+    char *data;
+    int head;
+    int tail;
+
+    long num_of_reads;
+    long num_of_writes;
+    long num_of_hits;
+};
+
+/* Reads 'size' bytes at 'offset' of 'fd' into 'buf'. The part after the end
+ * of the file reads as zeros, like a hole.
+ * Returns 0 if successful, 1 otherwise. */
+static int read_full(int fd, char *buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, offset);
+        if (n < 0) {
+            return 1;
+        }
+        if (n == 0) {
+            memset(buf, 0, size);
+            return 0;
+        }
+        buf += n;
+        size -= (size_t) n;
+        offset += n;
+    }
+    return 0;
+}
+
+/* Writes 'size' bytes of 'buf' at 'offset' of 'fd'.
+ * Returns 0 if successful, 1 otherwise. */
+static int write_full(int fd, const char *buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, buf, size, offset);
+        if (n <= 0) {
+            return 1;
+        }
+        buf += n;
+        size -= (size_t) n;
+        offset += n;
+    }
+    return 0;
+}
+
+static char *slot_data(const struct tile_cache *c, int s) {
+    return c->data + (size_t) s * c->record_size;
+}
+
+/* Writes slot 's' back to the file if it was changed.
+ * Returns 0 if successful, 1 otherwise. */
+static int write_back(struct tile_cache *c, int s) {
+    struct slot *slot = &c->slots[s];
+    if (!slot->dirty) {
+        return 0;
+    }
+    if (write_full(c->fd, slot_data(c, s), c->record_size,
+                   (off_t) (slot->record * c->record_size))) {
+        return 1;
+    }
+    slot->dirty = false;
+    c->num_of_writes++;
+    return 0;
+}
+
+/* Takes slot 's' out of the LRU list. */
+static void unlink_slot(struct tile_cache *c, int s) {
+    struct slot *slot = &c->slots[s];
+    if (slot->prev != NONE) {
+        c->slots[slot->prev].next = slot->next;
+    } else {
+        c->head = slot->next;
+    }
+    if (slot->next != NONE) {
+        c->slots[slot->next].prev = slot->prev;
+    } else {
+        c->tail = slot->prev;
+    }
+}
+
+/* Puts slot 's' at the front of the LRU list. */
+static void push_front(struct tile_cache *c, int s) {
+    c->slots[s].prev = NONE;
+    c->slots[s].next = c->head;
+    if (c->head != NONE) {
+        c->slots[c->head].prev = s;
+    } else {
+        c->tail = s;
+    }
+    c->head = s;
+}
+
+struct tile_cache *tile_cache_init(int fd, size_t record_size,
+                                   size_t n_records, size_t n_slots) {
+    if (record_size == 0 || n_slots == 0 || n_slots > INT32_MAX) {
+        debug_print("Invalid size in tile_cache_init\n");
+        return NULL;
+    }
+    struct tile_cache *c = malloc(sizeof(struct tile_cache));
+    if (c == NULL) {
+        debug_print("Could not allocate memory for tile cache struct\n");
+        return NULL;
+    }
+
+    c->fd = fd;
+    c->record_size = record_size;
+    c->n_records = n_records;
+    c->n_slots = (int) n_slots;
+    c->slots = malloc(n_slots * sizeof(struct slot));
+    c->slot_of = malloc(n_records * sizeof(int));
+    c->data = malloc(n_slots * record_size);
+    if (c->slots == NULL || c->slot_of == NULL || c->data == NULL) {
+        debug_print("Could not allocate memory for tile cache slots\n");
+        tile_cache_cleanup(c);
+        return NULL;
+    }
+
+    c->head = NONE;
+    c->tail = NONE;
+    for (int s = 0; s < c->n_slots; s++) {
+        c->slots[s].record = SIZE_MAX;
+        c->slots[s].dirty = false;
+        push_front(c, s);
+    }
+    for (size_t k = 0; k < n_records; k++) {
+        c->slot_of[k] = NONE;
+    }
+
+    c->num_of_reads = 0;
+    c->num_of_writes = 0;
+    c->num_of_hits = 0;
+    return c;
+}
+
+void tile_cache_cleanup(struct tile_cache *c) {
+    if (c == NULL) {
+        debug_print("Invalid tile cache struct in tile_cache_cleanup\n");
+        return;
+    }
+
+    free(c->slots);
+    free(c->slot_of);
+    free(c->data);
+    free(c);
+}
+
+void tile_cache_stats(const struct tile_cache *c) {
+    if (c == NULL) {
+        debug_print("Invalid tile cache struct in tile_cache_stats\n");
+        return;
+    }
+
+    fprintf(stderr, "cache %ld %ld %ld\n", c->num_of_reads, c->num_of_writes,
+            c->num_of_hits);
+}
+
+void *tile_cache_get(struct tile_cache *c, size_t record, bool write) {
+    if (c == NULL || record >= c->n_records) {
+        debug_print("Invalid arguments in tile_cache_get\n");
+        return NULL;
+    }
+
+    int s = c->slot_of[record];
+    if (s != NONE) {
+        c->num_of_hits++;
+    } else {
+        // Evict the least recently used record
+        s = c->tail;
+        struct slot *slot = &c->slots[s];
+        if (write_back(c, s)) {
+            debug_print("Could not write back record in tile_cache_get\n");
+            return NULL;
+        }
+        if (slot->record != SIZE_MAX) {
+            c->slot_of[slot->record] = NONE;
+            slot->record = SIZE_MAX;
+        }
+        if (read_full(c->fd, slot_data(c, s), c->record_size,
+                      (off_t) (record * c->record_size))) {
+            debug_print("Could not read record in tile_cache_get\n");
+            return NULL;
+        }
+        slot->record = record;
+        c->slot_of[record] = s;
+        c->num_of_reads++;
+    }
+
+    if (c->head != s) {
+        unlink_slot(c, s);
+        push_front(c, s);
+    }
+    c->slots[s].dirty |= write;
+    return slot_data(c, s);
+}
+
+int tile_cache_flush(struct tile_cache *c) {
+    if (c == NULL) {
+        debug_print("Invalid tile cache struct in tile_cache_flush\n");
+        return 1;
+    }
+
+    int err = 0;
+    for (int s = 0; s < c->n_slots; s++) {
+        err |= write_back(c, s);
+    }
+    return err;
+}
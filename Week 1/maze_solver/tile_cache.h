@@ -0,0 +1,36 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Handle to a tile cache.
+ *
+ * A tile cache keeps up to 'n_slots' of the 'n_records' fixed size records
+ * of a file in memory. A record that is not in memory is read with one
+ * pread() into the least recently used slot, which is written back with one
+ * pwrite() first if it was changed. So a file much larger than the memory
+ * can be worked on a record at a time, with large sequential reads and
+ * writes. */
+struct tile_cache;
+
+/* Return a pointer to a tile cache for the records of 'record_size' bytes
+ * in the file 'fd', record k at offset k * record_size, if successful,
+ * otherwise return NULL. The file must be open for reading and writing. */
+struct tile_cache *tile_cache_init(int fd, size_t record_size,
+                                   size_t n_records, size_t n_slots);
+
+/* Cleanup tile cache. Changed records that are still in memory are lost,
+ * see tile_cache_flush(). */
+void tile_cache_cleanup(struct tile_cache *c);
+
+/* Print tile cache statistics to stderr.
+ * The format is: 'cache' num_of_reads num_of_writes num_of_hits */
+void tile_cache_stats(const struct tile_cache *c);
+
+/* Return a pointer to record 'record', which stays valid until the next
+ * call of tile_cache_get(). With 'write' the record is written back to the
+ * file when it is evicted.
+ * Return NULL if the record could not be read or a slot not written. */
+void *tile_cache_get(struct tile_cache *c, size_t record, bool write);
+
+/* Write every changed record in memory back to the file.
+ * Return 0 if successful, 1 otherwise. */
+int tile_cache_flush(struct tile_cache *c);